@@ -0,0 +1,150 @@
+#ifndef AFFINITY_HPP
+#define AFFINITY_HPP
+
+#include <sched.h>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Thread placement policies built from the Linux CPU topology in sysfs.
+// affinity_cpus gives the logical CPUs for a policy, in the order threads
+// should be placed on them, and pin_thread binds the calling thread to one.
+// Only CPUs in the process's starting affinity mask are used, so the
+// policies compose with taskset and batch schedulers.
+//
+//   none       no pinning
+//   compact    fill a socket core by core, both SMT siblings of a core
+//              before the next core
+//   scatter    round-robin over sockets, then cores, SMT siblings last
+//   cores      one logical CPU per physical core, compact order
+//   socket:N   only the CPUs of socket N, compact order
+
+struct LogicalCpu {
+  int cpu;
+  int core;
+  int socket;
+  // Position among the SMT siblings of its core
+  int smt;
+};
+
+enum AffinityPolicy {AFFINITY_NONE, AFFINITY_COMPACT, AFFINITY_SCATTER, AFFINITY_CORES, AFFINITY_SOCKET};
+
+inline int read_topology_value(const int cpu, const char* name) {
+  char path[128];
+  snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+  FILE* file = fopen(path, "r");
+  if(!file) return 0;
+  int value = 0;
+  if(fscanf(file, "%d", &value) != 1) value = 0;
+  fclose(file);
+  return value;
+}
+
+// The mask the process started with, saved on first use so that it can be
+// restored after pinning
+inline const cpu_set_t& initial_affinity() {
+  static cpu_set_t mask = []{
+    cpu_set_t m;
+    CPU_ZERO(&m);
+    if(sched_getaffinity(0, sizeof(m), &m) != 0) {
+      for(int cpu=0; cpu<CPU_SETSIZE; ++cpu) CPU_SET(cpu, &m);
+    }
+    return m;
+  }();
+  return mask;
+}
+
+inline std::vector<LogicalCpu> cpu_topology() {
+  std::vector<LogicalCpu> cpus;
+  const cpu_set_t& allowed = initial_affinity();
+  for(int cpu=0; cpu<CPU_SETSIZE; ++cpu) {
+    if(!CPU_ISSET(cpu, &allowed)) continue;
+    cpus.push_back({cpu, read_topology_value(cpu, "core_id"), read_topology_value(cpu, "physical_package_id"), 0});
+  }
+  // Siblings share a socket and core id, and are numbered in CPU order
+  std::sort(cpus.begin(), cpus.end(), [](const LogicalCpu& a, const LogicalCpu& b) {
+    if(a.socket != b.socket) return a.socket < b.socket;
+    if(a.core != b.core) return a.core < b.core;
+    return a.cpu < b.cpu;
+  });
+  for(size_t k=1; k<cpus.size(); ++k) {
+    if(cpus[k].socket == cpus[k-1].socket && cpus[k].core == cpus[k-1].core) cpus[k].smt = cpus[k-1].smt + 1;
+  }
+  return cpus;
+}
+
+// Parses "none", "compact", "scatter", "cores" or "socket:N"
+inline bool parse_affinity_policy(const char* name, AffinityPolicy& policy, int& socket) {
+  socket = -1;
+  if(strcmp(name, "none") == 0) policy = AFFINITY_NONE;
+  else if(strcmp(name, "compact") == 0) policy = AFFINITY_COMPACT;
+  else if(strcmp(name, "scatter") == 0) policy = AFFINITY_SCATTER;
+  else if(strcmp(name, "cores") == 0) policy = AFFINITY_CORES;
+  else if(strncmp(name, "socket:", 7) == 0) {
+    policy = AFFINITY_SOCKET;
+    socket = atoi(name + 7);
+  }
+  else return false;
+  return true;
+}
+
+// Empty for AFFINITY_NONE, or for a socket with no allowed CPUs
+inline std::vector<int> affinity_cpus(const AffinityPolicy policy, const int socket = -1) {
+  std::vector<LogicalCpu> topology = cpu_topology();
+  std::vector<int> cpus;
+  if(policy == AFFINITY_NONE) return cpus;
+
+  if(policy == AFFINITY_SCATTER) {
+    // Rank of each core within its socket, so that the n-th core of every
+    // socket comes before the (n+1)-th of any
+    std::vector<int> core_rank(topology.size(), 0);
+    for(size_t k=1; k<topology.size(); ++k) {
+      const bool same_socket = topology[k].socket == topology[k-1].socket;
+      const bool same_core = same_socket && topology[k].core == topology[k-1].core;
+      core_rank[k] = !same_socket ? 0 : core_rank[k-1] + !same_core;
+    }
+    std::vector<size_t> order(topology.size());
+    for(size_t k=0; k<order.size(); ++k) order[k] = k;
+    std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) {
+      if(topology[a].smt != topology[b].smt) return topology[a].smt < topology[b].smt;
+      if(core_rank[a] != core_rank[b]) return core_rank[a] < core_rank[b];
+      return topology[a].socket < topology[b].socket;
+    });
+    for(const size_t k : order) cpus.push_back(topology[k].cpu);
+    return cpus;
+  }
+
+  // Compact order is the topology order, so SMT siblings are adjacent
+  for(const LogicalCpu& cpu : topology) {
+    if(policy == AFFINITY_CORES && cpu.smt != 0) continue;
+    if(policy == AFFINITY_SOCKET && cpu.socket != socket) continue;
+    cpus.push_back(cpu.cpu);
+  }
+  return cpus;
+}
+
+// Binds the calling thread to one CPU, or back to the starting mask if cpu
+// is negative. Returns false if the kernel refuses.
+inline bool pin_thread(const int cpu) {
+  if(cpu < 0) return sched_setaffinity(0, sizeof(cpu_set_t), &initial_affinity()) == 0;
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  CPU_SET(cpu, &mask);
+  return sched_setaffinity(0, sizeof(mask), &mask) == 0;
+}
+
+// The CPU list as "0;2;4", for a CSV column
+inline std::string cpu_list(const std::vector<int>& cpus, const size_t n) {
+  if(cpus.empty()) return "any";
+  std::string list;
+  for(size_t k=0; k<n; ++k) {
+    if(k) list += ";";
+    list += std::to_string(cpus[k % cpus.size()]);
+  }
+  return list;
+}
+
+#endif
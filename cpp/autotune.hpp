@@ -0,0 +1,177 @@
+#ifndef AUTOTUNE_HPP
+#define AUTOTUNE_HPP
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Picks the fastest of a set of kernel configurations for a grid size,
+// precision, CPU model and number of available threads by timing each of
+// them, and remembers the winner in a CSV file so that later runs on the same
+// machine just look it up. The file is .jacobi_autotune.csv in the working
+// directory unless JACOBI_AUTOTUNE_CACHE names another. A later entry for the
+// same key overrides an earlier one, so retuning only appends.
+
+struct TuningKey {
+  std::string cpu_model;
+  std::string precision;
+  int nx;
+  int ny;
+  // omp_get_max_threads() or equivalent, since the same CPU model with a
+  // different number of threads available can have a different winner
+  int max_threads;
+};
+
+struct TunedConfig {
+  std::string kernel;
+  int tile_rows = 0;
+  int tile_cols = 0;
+  int n_threads = 1;
+  double ns_per_update = NAN;
+};
+
+// The model name from /proc/cpuinfo, with commas removed to keep the CSV
+// simple
+inline std::string cpu_model() {
+  std::string model = "unknown";
+  FILE* cpuinfo = fopen("/proc/cpuinfo", "r");
+  if(!cpuinfo) return model;
+  char line[256];
+  while(fgets(line, sizeof(line), cpuinfo)) {
+    if(strncmp(line, "model name", 10) == 0) {
+      const char* value = strchr(line, ':');
+      if(value) {
+        model = value + 1;
+        while(!model.empty() && (model.front() == ' ' || model.front() == '\t')) model.erase(0, 1);
+        while(!model.empty() && (model.back() == '\n' || model.back() == ' ')) model.pop_back();
+        for(char& c : model) if(c == ',') c = ' ';
+      }
+      break;
+    }
+  }
+  fclose(cpuinfo);
+  return model;
+}
+
+inline std::string autotune_cache_path() {
+  const char* env = getenv("JACOBI_AUTOTUNE_CACHE");
+  return env && *env ? env : ".jacobi_autotune.csv";
+}
+
+class AutotuneCache {
+  public:
+  static constexpr const char* header =
+    "cpu_model, precision, nx, ny, max_threads, kernel, tile_rows, tile_cols, "
+    "n_threads, ns_per_update";
+
+  explicit AutotuneCache(const std::string& path_in = autotune_cache_path()) :
+    path{path_in}
+  {
+    FILE* file = fopen(path.c_str(), "r");
+    if(!file) return;
+    char line[512];
+    while(fgets(line, sizeof(line), file)) {
+      Entry entry;
+      if(parse(line, entry)) entries.push_back(entry);
+    }
+    fclose(file);
+  }
+
+  bool lookup(const TuningKey& key, TunedConfig& config) const {
+    for(auto entry = entries.rbegin(); entry != entries.rend(); ++entry) {
+      if(matches(entry->key, key)) {
+        config = entry->config;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Appends to the file, writing the header if it is new. A cache that can't
+  // be written only costs the next run a retune, so that is a warning.
+  void store(const TuningKey& key, const TunedConfig& config) {
+    entries.push_back({key, config});
+    FILE* file = fopen(path.c_str(), "a");
+    if(!file) {
+      fprintf(stderr, "autotune: can't write %s, the result won't be cached\n", path.c_str());
+      return;
+    }
+    if(ftell(file) == 0) fprintf(file, "%s\n", header);
+    fprintf(file, "%s, %s, %d, %d, %d, %s, %d, %d, %d, %f\n", key.cpu_model.c_str(), key.precision.c_str(), key.nx,
+            key.ny, key.max_threads, config.kernel.c_str(), config.tile_rows, config.tile_cols, config.n_threads,
+            config.ns_per_update);
+    fclose(file);
+  }
+
+  const std::string& file_path() const {return path;}
+
+  private:
+    struct Entry {
+      TuningKey key;
+      TunedConfig config;
+    };
+
+    static bool matches(const TuningKey& a, const TuningKey& b) {
+      return a.cpu_model == b.cpu_model && a.precision == b.precision && a.nx == b.nx && a.ny == b.ny &&
+             a.max_threads == b.max_threads;
+    }
+
+    // Fields are separated by ", ". The header and malformed lines are
+    // skipped, including those written before max_threads was part of the
+    // key and any a kernel couldn't run: an unknown kernel name, or tiles
+    // with no rows or columns. The key is then retuned.
+    static bool parse(const char* line, Entry& entry) {
+      std::vector<std::string> fields;
+      const char* start = line;
+      while(true) {
+        const char* comma = strchr(start, ',');
+        const char* end = comma ? comma : start + strcspn(start, "\r\n");
+        fields.emplace_back(start, end);
+        if(!comma) break;
+        start = comma + 1;
+        while(*start == ' ') ++start;
+      }
+      if(fields.size() != 10 || fields[0] == "cpu_model") return false;
+      entry.key.cpu_model = fields[0];
+      entry.key.precision = fields[1];
+      entry.key.nx = atoi(fields[2].c_str());
+      entry.key.ny = atoi(fields[3].c_str());
+      entry.key.max_threads = atoi(fields[4].c_str());
+      entry.config.kernel = fields[5];
+      entry.config.tile_rows = atoi(fields[6].c_str());
+      entry.config.tile_cols = atoi(fields[7].c_str());
+      entry.config.n_threads = atoi(fields[8].c_str());
+      entry.config.ns_per_update = atof(fields[9].c_str());
+      if(entry.config.kernel == "tiled") {
+        if(entry.config.tile_rows <= 0 || entry.config.tile_cols <= 0) return false;
+      } else if(entry.config.kernel != "rows") {
+        return false;
+      }
+      return entry.key.nx > 0 && entry.key.ny > 0 && entry.key.max_threads > 0 && entry.config.n_threads > 0;
+    }
+
+    std::string path;
+    std::vector<Entry> entries;
+};
+
+// The cached configuration for key if there is one, unless retune is set.
+// Otherwise measure(config), which returns ns per point update, is called on
+// each candidate and the fastest is stored.
+template<typename Measure>
+TunedConfig autotune(AutotuneCache& cache, const TuningKey& key, const std::vector<TunedConfig>& candidates,
+                     Measure measure, bool& cache_hit, const bool retune = false) {
+  TunedConfig best;
+  cache_hit = !retune && cache.lookup(key, best);
+  if(cache_hit) return best;
+  for(TunedConfig candidate : candidates) {
+    candidate.ns_per_update = measure(candidate);
+    if(std::isnan(best.ns_per_update) || candidate.ns_per_update < best.ns_per_update) best = candidate;
+  }
+  cache.store(key, best);
+  return best;
+}
+
+#endif
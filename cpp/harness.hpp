@@ -0,0 +1,95 @@
+#ifndef HARNESS_HPP
+#define HARNESS_HPP
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <unistd.h>
+
+// In-process benchmarking: a number of untimed warm-up runs followed by timed
+// repetitions, each optionally preceded by flushing the caches, so that a
+// sample doesn't contain process startup. It only excludes first-touch page
+// faults if run() doesn't allocate, so kernels should be handed their
+// workspace, allocated and touched in setup() or before the harness.
+
+struct HarnessOptions {
+  int warmups = 1;
+  int repeats = 10;
+  bool flush_caches = false;
+};
+
+struct Stats {
+  double min = 0.0;
+  double median = 0.0;
+  double mean = 0.0;
+  double std = 0.0;
+  int n = 0;
+};
+
+inline Stats compute_stats(std::vector<double> samples) {
+  Stats stats;
+  stats.n = samples.size();
+  if(stats.n == 0) return stats;
+  std::sort(samples.begin(), samples.end());
+  stats.min = samples.front();
+  stats.median = stats.n%2 ? samples[stats.n/2] : 0.5*(samples[stats.n/2-1] + samples[stats.n/2]);
+  for(const double s : samples) stats.mean += s;
+  stats.mean /= stats.n;
+  for(const double s : samples) stats.std += (s - stats.mean)*(s - stats.mean);
+  stats.std = stats.n > 1 ? std::sqrt(stats.std/(stats.n-1)) : 0.0;
+  return stats;
+}
+
+// Evicts the caches by writing then reading a buffer twice the size of the
+// last-level cache
+class CacheFlusher {
+  public:
+  CacheFlusher(const bool enabled) {
+    if(!enabled) return;
+    long llc_size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if(llc_size <= 0) llc_size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if(llc_size <= 0) llc_size = 64L<<20;
+    buffer.resize(2*llc_size/sizeof(long));
+  }
+
+  void flush() {
+    for(size_t k=0; k<buffer.size(); ++k) buffer[k] = k;
+    long sum = 0;
+    for(size_t k=0; k<buffer.size(); ++k) sum += buffer[k];
+    sink = sum;
+  }
+
+  private:
+    std::vector<long> buffer;
+    volatile long sink;
+};
+
+inline double elapsed_ns(const std::chrono::steady_clock::time_point& start, const std::chrono::steady_clock::time_point& end) {
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// Calls setup() untimed before every run, e.g. to reset the initial guess, and
+// returns statistics of the run() times in nanoseconds
+template<typename Setup, typename Run>
+Stats run_harness(const HarnessOptions& options, Setup setup, Run run) {
+  CacheFlusher flusher(options.flush_caches);
+  for(int n=0; n<options.warmups; ++n) {
+    setup();
+    run();
+  }
+
+  std::vector<double> samples;
+  samples.reserve(options.repeats);
+  for(int n=0; n<options.repeats; ++n) {
+    setup();
+    if(options.flush_caches) flusher.flush();
+    auto start = std::chrono::steady_clock::now();
+    run();
+    auto end = std::chrono::steady_clock::now();
+    samples.push_back(elapsed_ns(start, end));
+  }
+  return compute_stats(samples);
+}
+
+#endif
@@ -0,0 +1,150 @@
+#include "jacobi_solver.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+namespace jacobi {
+
+JacobiSolver::JacobiSolver(int nx, int ny, real dx, real dy) :
+  p(nx, ny),
+  p_new(nx, ny),
+  last_residual{NAN}
+{
+  real D = 2.0*(dx*dx + dy*dy);
+  D_x = dy*dy/D;
+  D_y = dx*dx/D;
+  B = -(dx*dx*dy*dy)/D;
+}
+
+void JacobiSolver::reset() {
+  for(int i=0; i<p.nx; ++i) {
+    for(int j=0; j<p.ny; ++j) {
+      p(i,j) = 0.0;
+      p_new(i,j) = 0.0;
+    }
+  }
+  last_residual = NAN;
+}
+
+// The guess goes into both buffers, since a Chebyshev sweep reads the
+// previous iterate from p_new
+void JacobiSolver::set_initial_guess(const Array& guess) {
+  if(guess.nx != p.nx || guess.ny != p.ny) {
+    fprintf(stderr, "set_initial_guess: guess is %dx%d but the solver is %dx%d\n", guess.nx, guess.ny, p.nx, p.ny);
+    exit(1);
+  }
+  p = guess;
+  p_new = guess;
+  last_residual = NAN;
+}
+
+real JacobiSolver::sweep(const Array& b, const bool measure_change) {
+  real change = 0.0;
+  if(measure_change) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+        change += (p_new(i,j) - p(i,j))*(p_new(i,j) - p(i,j));
+      }
+    }
+  } else {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+  }
+  std::swap(p, p_new);
+  return change;
+}
+
+real JacobiSolver::chebyshev_sweep(const Array& b, const real omega, const bool measure_change) {
+  real change = 0.0;
+  if(measure_change) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        const real jacobi = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+        p_new(i,j) = omega*(jacobi - p_new(i,j)) + p_new(i,j);
+        change += (jacobi - p(i,j))*(jacobi - p(i,j));
+      }
+    }
+  } else {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        const real jacobi = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+        p_new(i,j) = omega*(jacobi - p_new(i,j)) + p_new(i,j);
+      }
+    }
+  }
+  std::swap(p, p_new);
+  return change;
+}
+
+double JacobiSolver::analytic_spectral_radius() const {
+  // The slowest mode is sin(pi x)*sin(pi y)
+  return 2.0*D_x*cos(M_PI/(p.nx-1)) + 2.0*D_y*cos(M_PI/(p.ny-1));
+}
+
+double JacobiSolver::measure_spectral_radius(const int iterations) const {
+  // Starting from a constant interior, which is mostly the slowest mode, the
+  // norm shrinks by the spectral radius per sweep
+  Array x(p.nx, p.ny);
+  Array x_new(p.nx, p.ny);
+  for(int i=1; i<p.nx-1; ++i) {
+    for(int j=1; j<p.ny-1; ++j) {
+      x(i,j) = 1.0;
+    }
+  }
+  double ratio = 0.0;
+  for(int iter = 0; iter<iterations; ++iter) {
+    double norm = 0.0;
+    double norm_new = 0.0;
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        x_new(i,j) = D_x*(x(i+1,j) + x(i-1,j)) + D_y*(x(i,j+1) + x(i,j-1));
+        norm += x(i,j)*x(i,j);
+        norm_new += x_new(i,j)*x_new(i,j);
+      }
+    }
+    ratio = std::sqrt(norm_new/norm);
+    // Rescaled so that it neither underflows nor overflows
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        x(i,j) = x_new(i,j)/ratio;
+      }
+    }
+  }
+  return ratio;
+}
+
+int JacobiSolver::solve(const Array& b, const SolverOptions& options) {
+  // Chebyshev acceleration (Golub and Varga) combines each Jacobi update with
+  // the previous iterate, with weights from the Chebyshev polynomials on
+  // [-rho, rho]. The first step is plain Jacobi.
+  const double rho = options.spectral_radius > 0.0 ? options.spectral_radius : analytic_spectral_radius();
+  double omega = 1.0;
+
+  // A Jacobi sweep changes each point by B times its residual, so the
+  // residual comes from the change without a separate pass
+  const double n_points = double(p.nx-2)*(p.ny-2);
+  for(int iter = 0; iter<options.max_iterations; ++iter) {
+    const bool check = options.tolerance > 0.0 &&
+      ((iter+1) % options.check_interval == 0 || iter == 0);
+    real change;
+    if(options.chebyshev && iter > 0) {
+      omega = iter == 1 ? 1.0/(1.0 - rho*rho/2.0) : 1.0/(1.0 - rho*rho*omega/4.0);
+      change = chebyshev_sweep(b, omega, check);
+    } else {
+      change = sweep(b, check);
+    }
+    if(check) {
+      last_residual = std::sqrt(change/n_points)/std::fabs(B);
+      if(last_residual < options.tolerance) return iter+1;
+    }
+  }
+  return options.max_iterations;
+}
+
+}
@@ -0,0 +1,90 @@
+#ifndef JACOBI_SOLVER_HPP
+#define JACOBI_SOLVER_HPP
+
+#include <vector>
+
+// The Array and Jacobi kernel of V008 as a reusable solver for the Poisson
+// equation on a uniform grid with zero boundary values. The solver owns its
+// workspace and keeps its solution between calls, so a sequence of similar
+// problems can each start from the previous answer (a warm start) instead of
+// from zero. Built into libjacobi_solver_<PRECISION>.a, so code is always
+// linked against a library of its own precision. Everything is in the jacobi
+// namespace so that it can be included alongside an application's own real
+// and Array.
+
+namespace jacobi {
+
+typedef PRECISION real;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(nx_in*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  int idx(int i, int j) const {return j + i*ny;}
+
+  int nx;
+  int ny;
+  private:
+    std::vector<real> data;
+};
+
+struct SolverOptions {
+  // Stop once the RMS residual of the discrete equation is below this, or 0
+  // to always run max_iterations
+  double tolerance = 0.0;
+  int max_iterations = 1<<16;
+  // Sweeps between residual checks. Only the checking sweeps pay for it.
+  int check_interval = 16;
+  // Chebyshev semi-iterative acceleration, which needs the spectral radius
+  // of the Jacobi iteration matrix, or 0 to use the analytic one for the grid
+  bool chebyshev = false;
+  double spectral_radius = 0.0;
+};
+
+class JacobiSolver {
+  public:
+  JacobiSolver(int nx, int ny, real dx, real dy);
+
+  // Iterates from the current solution: zero after construction or reset(),
+  // otherwise the result of the last solve or the guess given. Returns the
+  // number of sweeps done.
+  int solve(const Array& b, const SolverOptions& options);
+
+  // Cold start: the next solve begins from zero
+  void reset();
+  void set_initial_guess(const Array& guess);
+
+  // Largest eigenvalue magnitude of the Jacobi iteration matrix, known
+  // exactly for this model problem
+  double analytic_spectral_radius() const;
+  // The same estimated by power iterations on the homogeneous problem, for
+  // when no formula is available
+  double measure_spectral_radius(const int iterations) const;
+
+  const Array& solution() const {return p;}
+  // RMS residual as of the last check, NaN before the first
+  double residual() const {return last_residual;}
+
+  private:
+    // One sweep of p into p_new, returning the sum of squared changes if
+    // measure_change is set
+    real sweep(const Array& b, const bool measure_change);
+    // A Chebyshev step: p_new becomes omega*(Jacobi(p) - p_new) + p_new, so it
+    // has to hold the previous iterate on entry
+    real chebyshev_sweep(const Array& b, const real omega, const bool measure_change);
+
+    Array p;
+    Array p_new;
+    real D_x;
+    real D_y;
+    real B;
+    double last_residual;
+};
+
+}
+
+#endif
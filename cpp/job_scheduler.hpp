@@ -0,0 +1,155 @@
+#ifndef JOB_SCHEDULER_HPP
+#define JOB_SCHEDULER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A pool of workers, one per core by default, each with its own deque of
+// tasks. A worker takes its newest task first, which is usually the one
+// whose data is still in cache, and when it runs dry it steals the oldest
+// task from another worker. Tasks may submit more tasks, which go onto the
+// submitting worker's own deque, so a job can split itself into pieces that
+// idle workers then pick up.
+
+typedef std::function<void()> Task;
+
+class WorkStealingDeque {
+  public:
+  void push(Task task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+  }
+
+  bool pop(Task& task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(tasks.empty()) return false;
+    task = std::move(tasks.back());
+    tasks.pop_back();
+    return true;
+  }
+
+  bool steal(Task& task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(tasks.empty()) return false;
+    task = std::move(tasks.front());
+    tasks.pop_front();
+    return true;
+  }
+
+  private:
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+class Scheduler {
+  public:
+  explicit Scheduler(int n_workers_in = 0) {
+    const int n = n_workers_in > 0 ? n_workers_in : std::max(1u, std::thread::hardware_concurrency());
+    for(int w=0; w<n; ++w) deques.emplace_back(new WorkStealingDeque);
+    for(int w=0; w<n; ++w) workers.emplace_back(&Scheduler::worker_loop, this, w);
+  }
+
+  ~Scheduler() {
+    wait();
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for(auto& worker : workers) worker.join();
+  }
+
+  // From a worker, the task goes onto that worker's deque; from outside, the
+  // deques are filled in turn
+  void submit(Task task) {
+    pending.fetch_add(1);
+    const int w = current().owner == this ? current().id : next_deque.fetch_add(1) % deques.size();
+    deques[w]->push(std::move(task));
+    queued.fetch_add(1);
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    wake.notify_one();
+  }
+
+  // Until every task submitted, and every task those submitted, has finished
+  void wait() {
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    idle.wait(lock, [this]{return pending.load() == 0;});
+  }
+
+  int n_workers() const {return workers.size();}
+  long tasks_run() const {return n_tasks_run.load();}
+  long steals() const {return n_steals.load();}
+
+  private:
+    void worker_loop(const int id) {
+      current() = {this, id};
+      Task task;
+      while(true) {
+        if(!find_task(id, task)) {
+          std::unique_lock<std::mutex> lock(sleep_mutex);
+          wake.wait(lock, [this]{return stopping || queued.load() > 0;});
+          if(stopping) return;
+          continue;
+        }
+        task();
+        task = nullptr;
+        n_tasks_run.fetch_add(1, std::memory_order_relaxed);
+        if(pending.fetch_sub(1) == 1) {
+          std::lock_guard<std::mutex> lock(sleep_mutex);
+          idle.notify_all();
+        }
+      }
+    }
+
+    bool find_task(const int id, Task& task) {
+      if(deques[id]->pop(task)) {
+        queued.fetch_sub(1);
+        return true;
+      }
+      // Victims in turn starting from the next worker, so that thieves
+      // spread out instead of all hitting worker 0
+      const int n = deques.size();
+      for(int k=1; k<n; ++k) {
+        if(deques[(id+k) % n]->steal(task)) {
+          queued.fetch_sub(1);
+          n_steals.fetch_add(1, std::memory_order_relaxed);
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Which worker of which scheduler the calling thread is, if any
+    struct Worker {
+      const Scheduler* owner;
+      int id;
+    };
+    static Worker& current() {
+      static thread_local Worker worker = {nullptr, -1};
+      return worker;
+    }
+
+    std::vector<std::unique_ptr<WorkStealingDeque>> deques;
+    std::vector<std::thread> workers;
+    // Submitted and not yet finished, and sitting in a deque
+    std::atomic<long> pending{0};
+    std::atomic<long> queued{0};
+    std::atomic<long> n_tasks_run{0};
+    std::atomic<long> n_steals{0};
+    std::atomic<unsigned> next_deque{0};
+    bool stopping = false;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef KERNEL_REGISTRY_HPP
+#define KERNEL_REGISTRY_HPP
+
+#include <vector>
+
+// A registry of Jacobi kernels, so that one driver can run any of the variants
+// in-process on the same inputs. Kernels are templated on the precision and
+// REGISTER_KERNEL adds both the float and double instantiations.
+//
+// Every kernel takes row-major nx*ny arrays and leaves its result in p. Those
+// ported from variants with the grid size baked in at compile time declare
+// that size, and the driver only runs them at exactly that size.
+
+template<typename real>
+struct Grid {
+  int nx;
+  int ny;
+  real dx;
+  real dy;
+  int max_iterations;
+};
+
+template<typename real>
+using KernelFunction = void (*)(real* p, const real* b, const Grid<real>& grid);
+
+template<typename real>
+struct KernelInfo {
+  const char* name;
+  const char* language;
+  int fixed_nx;  // 0 if the size is only known at run time
+  int fixed_ny;
+  KernelFunction<real> run;
+
+  bool compile_time_size() const {return fixed_nx > 0;}
+  bool supports(const int nx, const int ny) const {
+    return !compile_time_size() || (nx == fixed_nx && ny == fixed_ny);
+  }
+};
+
+template<typename real> const char* precision_name();
+template<> inline const char* precision_name<float>() {return "float";}
+template<> inline const char* precision_name<double>() {return "double";}
+
+// A function-local static, so that registration from static initialisers in
+// any translation unit is safe
+template<typename real>
+std::vector<KernelInfo<real>>& kernel_registry() {
+  static std::vector<KernelInfo<real>> registry;
+  return registry;
+}
+
+template<typename real>
+struct KernelRegistrar {
+  KernelRegistrar(const KernelInfo<real>& info) {
+    kernel_registry<real>().push_back(info);
+  }
+};
+
+#define REGISTER_KERNEL(name, language, fixed_nx, fixed_ny, function) \
+  static KernelRegistrar<float> function##_float_registrar({name, language, fixed_nx, fixed_ny, function<float>}); \
+  static KernelRegistrar<double> function##_double_registrar({name, language, fixed_nx, fixed_ny, function<double>});
+
+#endif
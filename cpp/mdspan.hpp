@@ -0,0 +1,119 @@
+#ifndef MDSPAN_HPP
+#define MDSPAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// A minimal 2D subset of C++23 std::mdspan, which GCC doesn't ship before
+// version 14. As in the standard, a layout policy's mapping turns a
+// multidimensional index into an offset, and mdspan is a non-owning view of
+// a pointer through that mapping. Only dynamic 2D extents are supported and
+// elements are accessed with operator(), as in the Kokkos reference
+// implementation, rather than the multi-argument operator[].
+//
+// Besides the standard layout_right (row-major) and layout_left
+// (column-major) this adds layout_tiled, square tiles stored one after
+// another, and layout_morton, the Z-order curve.
+
+struct extents {
+  int nx;
+  int ny;
+
+  int extent(const int r) const {return r == 0 ? nx : ny;}
+};
+
+struct layout_right {
+  struct mapping {
+    mapping(const extents& e) : ext{e} {}
+    size_t operator()(const int i, const int j) const {return j + size_t(i)*ext.ny;}
+    size_t required_span_size() const {return size_t(ext.nx)*ext.ny;}
+
+    extents ext;
+  };
+  static constexpr const char* name = "right";
+};
+
+struct layout_left {
+  struct mapping {
+    mapping(const extents& e) : ext{e} {}
+    size_t operator()(const int i, const int j) const {return i + size_t(j)*ext.nx;}
+    size_t required_span_size() const {return size_t(ext.nx)*ext.ny;}
+
+    extents ext;
+  };
+  static constexpr const char* name = "left";
+};
+
+// TILE x TILE tiles, row-major within a tile and tiles row-major in the
+// grid, so neighbouring rows are close in memory. The extents are padded up
+// to whole tiles.
+template<int TILE>
+struct layout_tiled {
+  static_assert((TILE & (TILE-1)) == 0, "TILE must be a power of two");
+
+  struct mapping {
+    mapping(const extents& e) :
+      ext{e},
+      tiles_y{(e.ny + TILE-1)/TILE}
+    {}
+    size_t operator()(const int i, const int j) const {
+      // Unsigned, so that / and % are plain shifts and masks
+      const unsigned ui = i;
+      const unsigned uj = j;
+      const size_t tile = size_t(ui/TILE)*tiles_y + uj/TILE;
+      return tile*TILE*TILE + (ui%TILE)*TILE + uj%TILE;
+    }
+    size_t required_span_size() const {return size_t((ext.nx + TILE-1)/TILE)*tiles_y*TILE*TILE;}
+
+    extents ext;
+    int tiles_y;
+  };
+  static constexpr const char* name = TILE == 8 ? "tiled8" : TILE == 16 ? "tiled16" : "tiled";
+};
+
+// Z-order: the bits of i and j interleaved, so every aligned 2^k x 2^k block
+// is contiguous. Both extents are padded up to the same power of two, which
+// wastes memory for rectangular grids.
+struct layout_morton {
+  // Spreads the low 32 bits of x out to the even bits
+  static uint64_t spread_bits(uint64_t x) {
+    x &= 0xffffffff;
+    x = (x | (x << 16)) & 0x0000ffff0000ffff;
+    x = (x | (x << 8)) & 0x00ff00ff00ff00ff;
+    x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0f;
+    x = (x | (x << 2)) & 0x3333333333333333;
+    x = (x | (x << 1)) & 0x5555555555555555;
+    return x;
+  }
+
+  struct mapping {
+    mapping(const extents& e) : ext{e}, side{1} {
+      while(side < size_t(e.nx) || side < size_t(e.ny)) side *= 2;
+    }
+    size_t operator()(const int i, const int j) const {return (spread_bits(i) << 1) | spread_bits(j);}
+    size_t required_span_size() const {return side*side;}
+
+    extents ext;
+    size_t side;
+  };
+  static constexpr const char* name = "morton";
+};
+
+template<typename T, typename Layout>
+class mdspan {
+  public:
+  typedef typename Layout::mapping mapping_type;
+
+  mdspan(T* data_in, const extents& e) : ptr{data_in}, map{e} {}
+
+  T& operator()(const int i, const int j) const {return ptr[map(i,j)];}
+  int extent(const int r) const {return map.ext.extent(r);}
+  const mapping_type& mapping() const {return map;}
+  T* data_handle() const {return ptr;}
+
+  private:
+    T* ptr;
+    mapping_type map;
+};
+
+#endif
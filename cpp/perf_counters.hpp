@@ -0,0 +1,146 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Hardware performance counters read through perf_event_open, for the calling
+// thread only and excluding the kernel. Counters are only opened when
+// enabled, so a disabled instance costs nothing. Each counter is opened on its
+// own: any the CPU, kernel or perf_event_paranoid setting refuses (as in most
+// VMs) simply reads as NaN instead of disabling the rest.
+
+class PerfCounters {
+  public:
+  enum Event {CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, VECTOR_INSTRUCTIONS, N_EVENTS};
+
+  // Enabled by setting JACOBI_PERF_COUNTERS=1 in the environment
+  static bool enabled_by_env() {
+    const char* env = getenv("JACOBI_PERF_COUNTERS");
+    return env && atoi(env);
+  }
+
+  explicit PerfCounters(const bool enabled_in = enabled_by_env()) :
+    enabled{enabled_in}
+  {
+    for(int k=0; k<N_EVENTS; ++k) {
+      fds[k] = -1;
+      values[k] = NAN;
+    }
+    if(!enabled) return;
+
+    const uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    const uint64_t llc_read_miss = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    fds[CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds[INSTRUCTIONS] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds[L1D_MISSES] = open_event(PERF_TYPE_HW_CACHE, l1d_read_miss);
+    fds[LLC_MISSES] = open_event(PERF_TYPE_HW_CACHE, llc_read_miss);
+    // There is no generic event for vector instructions. On Intel (Skylake
+    // onwards) FP_ARITH_INST_RETIRED with umask 0xfc counts every packed
+    // 128, 256 and 512-bit floating point instruction. Elsewhere the same
+    // raw code means something else or nothing, so it is left as NaN.
+    if(has_fp_arith_event()) {
+      fds[VECTOR_INSTRUCTIONS] = open_event(PERF_TYPE_RAW, 0xfcc7);
+    }
+  }
+
+  ~PerfCounters() {
+    for(int k=0; k<N_EVENTS; ++k) {
+      if(fds[k] >= 0) close(fds[k]);
+    }
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  void start() {
+    for(int k=0; k<N_EVENTS; ++k) {
+      if(fds[k] < 0) continue;
+      ioctl(fds[k], PERF_EVENT_IOC_RESET, 0);
+      ioctl(fds[k], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  void stop() {
+    for(int k=0; k<N_EVENTS; ++k) {
+      if(fds[k] < 0) continue;
+      ioctl(fds[k], PERF_EVENT_IOC_DISABLE, 0);
+      // Scale up if the counter was multiplexed with others
+      uint64_t data[3];
+      if(read(fds[k], data, sizeof(data)) == sizeof(data) && data[2] > 0) {
+        values[k] = double(data[0])*double(data[1])/double(data[2]);
+      }
+    }
+  }
+
+  // NaN if the counter is disabled or unavailable
+  double value(const Event event) const {return values[event];}
+
+  // In Event order, which the v017 EXTRA_COLUMNS in the makefile follow
+  void print_csv(FILE* file) const {
+    for(int k=0; k<N_EVENTS; ++k) {
+      fprintf(file, ", %.0f", values[k]);
+    }
+  }
+
+  private:
+    static int open_event(const uint32_t type, const uint64_t config) {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = type;
+      attr.config = config;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    // Intel family 6 big cores from Skylake on, by model number. Atom cores
+    // share the family but not the event, so unknown models are excluded.
+    static bool has_fp_arith_event() {
+      FILE* cpuinfo = fopen("/proc/cpuinfo", "r");
+      if(!cpuinfo) return false;
+      char line[256];
+      bool intel = false;
+      int family = -1;
+      int model = -1;
+      while(fgets(line, sizeof(line), cpuinfo) && model < 0) {
+        const char* value = strchr(line, ':');
+        if(!value) continue;
+        if(strncmp(line, "vendor_id", 9) == 0) intel = strstr(value, "GenuineIntel") != nullptr;
+        else if(strncmp(line, "cpu family", 10) == 0) family = atoi(value + 1);
+        else if(strncmp(line, "model\t", 6) == 0 || strncmp(line, "model ", 6) == 0) model = atoi(value + 1);
+      }
+      fclose(cpuinfo);
+      if(!intel || family != 6) return false;
+      static const int models[] = {
+        0x4e, 0x5e,                    // Skylake
+        0x55,                          // Skylake-SP, Cascade Lake, Cooper Lake
+        0x8e, 0x9e, 0xa5, 0xa6,        // Kaby, Coffee, Whiskey and Comet Lake
+        0x66,                          // Cannon Lake
+        0x6a, 0x6c, 0x7d, 0x7e,        // Ice Lake
+        0x8c, 0x8d, 0xa7,              // Tiger Lake, Rocket Lake
+        0x97, 0x9a, 0xb7, 0xba, 0xbf,  // Alder Lake, Raptor Lake
+        0x8f, 0xcf, 0xad, 0xae,        // Sapphire, Emerald and Granite Rapids
+      };
+      for(const int m : models) {
+        if(m == model) return true;
+      }
+      return false;
+    }
+
+    bool enabled;
+    int fds[N_EVENTS];
+    double values[N_EVENTS];
+};
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef POISSON_DST_HPP
+#define POISSON_DST_HPP
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+// Direct solver for the same discrete Poisson problem as the Jacobi kernels:
+// the 5-point Laplacian on a uniform nx x ny grid with zero boundary values.
+// The discrete sine transform (DST-I) diagonalises that Laplacian, so the
+// solution is a 2D DST of b, a division by the eigenvalues, and the inverse
+// DST, in O(N^2 log N). It is exactly the fixed point Jacobi converges to,
+// up to rounding.
+//
+// Self-contained, so no FFTW: a DST-I of length n is an FFT of length
+// 2(n+1), done with radix-2 for powers of two and Bluestein's algorithm,
+// which turns it into a power-of-two convolution, otherwise. The transforms
+// are in double precision whatever the precision of the arrays.
+
+typedef std::complex<double> complex_t;
+
+// Written out, as std::complex multiplication goes through a libgcc call
+// that handles infinities unless -ffast-math is on
+inline complex_t cmul(const complex_t a, const complex_t b) {
+  return complex_t(a.real()*b.real() - a.imag()*b.imag(), a.real()*b.imag() + a.imag()*b.real());
+}
+
+class FFT {
+  public:
+  explicit FFT(const size_t n_in) : n{n_in}, m{1} {
+    while(m < n) m *= 2;
+    bluestein = m != n;
+    if(bluestein) {
+      m = 1;
+      while(m < 2*n-1) m *= 2;
+    }
+    twiddles.resize(m/2);
+    for(size_t k=0; k<m/2; ++k) twiddles[k] = std::polar(1.0, -2.0*M_PI*k/m);
+
+    if(bluestein) {
+      // chirp_k = exp(-i pi k^2/n), with k^2 reduced mod 2n to keep the
+      // angle accurate
+      chirp.resize(n);
+      for(size_t k=0; k<n; ++k) chirp[k] = std::polar(1.0, -M_PI*double((k*k) % (2*n))/n);
+      filter.assign(m, 0.0);
+      filter[0] = std::conj(chirp[0]);
+      for(size_t k=1; k<n; ++k) filter[k] = filter[m-k] = std::conj(chirp[k]);
+      radix2(filter.data(), false);
+      // Folds in the 1/m of the inverse transform
+      for(size_t k=0; k<m; ++k) filter[k] /= double(m);
+      work.resize(m);
+    }
+  }
+
+  // Unnormalised forward transform of x[0..n), in place
+  void forward(complex_t* x) {
+    if(!bluestein) {
+      radix2(x, false);
+      return;
+    }
+    for(size_t k=0; k<n; ++k) work[k] = cmul(x[k], chirp[k]);
+    for(size_t k=n; k<m; ++k) work[k] = 0.0;
+    radix2(work.data(), false);
+    for(size_t k=0; k<m; ++k) work[k] = cmul(work[k], filter[k]);
+    radix2(work.data(), true);
+    for(size_t k=0; k<n; ++k) x[k] = cmul(work[k], chirp[k]);
+  }
+
+  private:
+    // Iterative Cooley-Tukey on m points
+    void radix2(complex_t* x, const bool inverse) const {
+      for(size_t i=1, j=0; i<m; ++i) {
+        size_t bit = m >> 1;
+        for(; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if(i < j) std::swap(x[i], x[j]);
+      }
+      for(size_t len=2; len<=m; len*=2) {
+        const size_t step = m/len;
+        for(size_t start=0; start<m; start+=len) {
+          for(size_t k=0; k<len/2; ++k) {
+            const complex_t w = inverse ? std::conj(twiddles[k*step]) : twiddles[k*step];
+            const complex_t u = x[start+k];
+            const complex_t v = cmul(x[start+k+len/2], w);
+            x[start+k] = u + v;
+            x[start+k+len/2] = u - v;
+          }
+        }
+      }
+    }
+
+    size_t n;
+    size_t m;
+    bool bluestein;
+    std::vector<complex_t> twiddles;
+    std::vector<complex_t> chirp;
+    std::vector<complex_t> filter;
+    std::vector<complex_t> work;
+};
+
+// y_k = sum_{j=1..n} x_j sin(pi j k/(n+1)) for k = 1..n, through the FFT of
+// the odd extension [0, x, 0, -reversed x]. That FFT is -2i y, purely
+// imaginary, so two real lines go through one complex FFT as its real and
+// imaginary parts and come out as its imaginary and real parts.
+class DST {
+  public:
+  explicit DST(const size_t n_in) : n{n_in}, fft{2*(n_in+1)}, buffer(2*(n_in+1)) {}
+
+  // Transforms two contiguous lines of n values in place. The second may be
+  // null.
+  void transform(double* x1, double* x2) {
+    buffer[0] = 0.0;
+    buffer[n+1] = 0.0;
+    for(size_t j=1; j<=n; ++j) {
+      const complex_t z(x1[j-1], x2 ? x2[j-1] : 0.0);
+      buffer[j] = z;
+      buffer[2*(n+1)-j] = -z;
+    }
+    fft.forward(buffer.data());
+    for(size_t k=1; k<=n; ++k) {
+      x1[k-1] = -0.5*buffer[k].imag();
+      if(x2) x2[k-1] = 0.5*buffer[k].real();
+    }
+  }
+
+  private:
+    size_t n;
+    FFT fft;
+    std::vector<complex_t> buffer;
+};
+
+class PoissonDST {
+  public:
+  PoissonDST(const int nx_in, const int ny_in, const double dx, const double dy) :
+    nx{nx_in}, ny{ny_in},
+    dst_x(nx_in-2), dst_y(ny_in-2),
+    eigenvalues(size_t(nx_in-2)*(ny_in-2)),
+    work(size_t(nx_in-2)*(ny_in-2)),
+    work_t(size_t(nx_in-2)*(ny_in-2))
+  {
+    // Eigenvalues of the 5-point Laplacian for mode (k,l), times the
+    // normalisation of the two inverse transforms. Stored transposed, as
+    // that is how the spectrum is laid out when they are applied.
+    const double scale = 4.0/((nx-1)*(ny-1));
+    for(int l=1; l<=ny-2; ++l) {
+      for(int k=1; k<=nx-2; ++k) {
+        const double lambda = (2.0*cos(M_PI*k/(nx-1)) - 2.0)/(dx*dx) + (2.0*cos(M_PI*l/(ny-1)) - 2.0)/(dy*dy);
+        eigenvalues[(k-1) + size_t(l-1)*(nx-2)] = lambda/scale;
+      }
+    }
+  }
+
+  // Solves for the interior of p from the interior of b. The boundary of p
+  // is left as it is, and should be zero.
+  template<typename Array>
+  void solve(const Array& b, Array& p) {
+    const int mx = nx-2;
+    const int my = ny-2;
+    for(int i=0; i<mx; ++i) {
+      for(int j=0; j<my; ++j) {
+        work[j + size_t(i)*my] = b(i+1,j+1);
+      }
+    }
+
+    // DST-I is its own inverse up to a factor of 2/(n+1), which is folded
+    // into the eigenvalues. The columns are transformed as rows of the
+    // transpose rather than with a stride of a whole row.
+    transform_rows(work, mx, my, dst_y);
+    transpose(work, work_t, mx, my);
+    transform_rows(work_t, my, mx, dst_x);
+    for(size_t k=0; k<work_t.size(); ++k) work_t[k] /= eigenvalues[k];
+    transform_rows(work_t, my, mx, dst_x);
+    transpose(work_t, work, my, mx);
+    transform_rows(work, mx, my, dst_y);
+
+    for(int i=0; i<mx; ++i) {
+      for(int j=0; j<my; ++j) {
+        p(i+1,j+1) = work[j + size_t(i)*my];
+      }
+    }
+  }
+
+  private:
+    static void transform_rows(std::vector<double>& data, const int rows, const int cols, DST& dst) {
+      for(int i=0; i<rows; i+=2) {
+        dst.transform(data.data() + size_t(i)*cols, i+1 < rows ? data.data() + size_t(i+1)*cols : nullptr);
+      }
+    }
+
+    // in is rows x cols, out becomes cols x rows, in tiles that stay in cache
+    static void transpose(const std::vector<double>& in, std::vector<double>& out, const int rows, const int cols) {
+      const int TILE = 32;
+      for(int ii=0; ii<rows; ii+=TILE) {
+        for(int jj=0; jj<cols; jj+=TILE) {
+          for(int i=ii; i<std::min(ii+TILE, rows); ++i) {
+            for(int j=jj; j<std::min(jj+TILE, cols); ++j) {
+              out[i + size_t(j)*rows] = in[j + size_t(i)*cols];
+            }
+          }
+        }
+      }
+    }
+
+    int nx;
+    int ny;
+    DST dst_x;
+    DST dst_y;
+    std::vector<double> eigenvalues;
+    std::vector<double> work;
+    std::vector<double> work_t;
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef REDUCTIONS_HPP
+#define REDUCTIONS_HPP
+
+#include <vector>
+#include <cstddef>
+
+// Sums that give the same bits on any number of threads. The range is cut
+// into blocks whose boundaries depend only on its size. Each block is summed
+// serially with Kahan compensation into LANES independent accumulators, so
+// the loop still vectorises, and the block totals are then combined by a
+// pairwise tree of fixed shape. Threads only decide who computes which
+// block, never the order of any addition.
+//
+// With OpenMP the blocks are shared between threads, otherwise they are
+// summed in turn, with the same result.
+
+const int REDUCTION_LANES = 8;
+const int REDUCTION_ROWS_PER_BLOCK = 4;
+const size_t REDUCTION_BLOCK_SIZE = 4096;
+
+template<typename real>
+struct KahanLanes {
+  real sum[REDUCTION_LANES] = {};
+  real comp[REDUCTION_LANES] = {};
+
+  // Adds f(k) for k in [begin,end), element k going to lane k-begin mod LANES
+  template<typename F>
+  void add(const long begin, const long end, F f) {
+    long k = begin;
+    for(; k + REDUCTION_LANES <= end; k += REDUCTION_LANES) {
+      #pragma GCC ivdep
+      for(int l=0; l<REDUCTION_LANES; ++l) {
+        const real y = f(k+l) - comp[l];
+        const real t = sum[l] + y;
+        comp[l] = (t - sum[l]) - y;
+        sum[l] = t;
+      }
+    }
+    for(int l=0; k<end; ++k, ++l) {
+      const real y = f(k) - comp[l];
+      const real t = sum[l] + y;
+      comp[l] = (t - sum[l]) - y;
+      sum[l] = t;
+    }
+  }
+
+  real total() const {
+    real lanes[REDUCTION_LANES];
+    for(int l=0; l<REDUCTION_LANES; ++l) lanes[l] = sum[l] - comp[l];
+    for(int stride=1; stride<REDUCTION_LANES; stride*=2) {
+      for(int l=0; l+stride<REDUCTION_LANES; l+=2*stride) lanes[l] += lanes[l+stride];
+    }
+    return lanes[0];
+  }
+};
+
+// Fixed-shape pairwise tree: neighbours, then pairs of pairs, and so on
+template<typename real>
+real pairwise_combine(std::vector<real>& values) {
+  const size_t n = values.size();
+  if(n == 0) return 0.0;
+  for(size_t stride=1; stride<n; stride*=2) {
+    for(size_t k=0; k+stride<n; k+=2*stride) values[k] += values[k+stride];
+  }
+  return values[0];
+}
+
+// block_sum(b) must depend only on b
+template<typename real, typename BlockSum>
+real reduce_blocks(const long n_blocks, BlockSum block_sum) {
+  std::vector<real> partial(n_blocks);
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(long b=0; b<n_blocks; ++b) {
+    partial[b] = block_sum(b);
+  }
+  return pairwise_combine(partial);
+}
+
+// Sum of f(i,j) over i in [i0,i1) and j in [j0,j1), in blocks of rows
+template<typename real, typename F>
+real deterministic_sum(const int i0, const int i1, const int j0, const int j1, F f) {
+  if(i1 <= i0 || j1 <= j0) return 0.0;
+  const long n_blocks = (i1 - i0 + REDUCTION_ROWS_PER_BLOCK-1)/REDUCTION_ROWS_PER_BLOCK;
+  return reduce_blocks<real>(n_blocks, [&](const long b) {
+    KahanLanes<real> acc;
+    const int row_begin = i0 + b*REDUCTION_ROWS_PER_BLOCK;
+    const int row_end = row_begin + REDUCTION_ROWS_PER_BLOCK < i1 ? row_begin + REDUCTION_ROWS_PER_BLOCK : i1;
+    for(int i=row_begin; i<row_end; ++i) {
+      acc.add(j0, j1, [&](const long j) {return f(i, int(j));});
+    }
+    return acc.total();
+  });
+}
+
+// Sum of f(k) over k in [0,n), in blocks of elements
+template<typename real, typename F>
+real deterministic_sum(const size_t n, F f) {
+  const long n_blocks = (n + REDUCTION_BLOCK_SIZE-1)/REDUCTION_BLOCK_SIZE;
+  return reduce_blocks<real>(n_blocks, [&](const long b) {
+    KahanLanes<real> acc;
+    const size_t begin = b*REDUCTION_BLOCK_SIZE;
+    const size_t end = begin + REDUCTION_BLOCK_SIZE < n ? begin + REDUCTION_BLOCK_SIZE : n;
+    acc.add(begin, end, f);
+    return acc.total();
+  });
+}
+
+template<typename real>
+real deterministic_dot(const real* a, const real* b, const size_t n) {
+  return deterministic_sum<real>(n, [&](const long k) {return a[k]*b[k];});
+}
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef ROOFLINE_HPP
+#define ROOFLINE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <unistd.h>
+
+// Roofline model for the Jacobi stencil. The host's peak floating point
+// throughput and its sustainable bandwidth from L2, L3 and memory are probed
+// at startup, and a kernel's achieved rates are derived from the known flop
+// and byte counts of a sweep. The memory roof is the bandwidth of the
+// smallest level that holds the kernel's working set, since a grid that fits
+// in cache is not limited by DRAM.
+//
+// Each point update is D_x*(a + b) + D_y*(c + d) + B*e: 7 flops. With the
+// neighbouring rows of p reused from cache, a sweep has to read p and b and
+// write p_new, which also costs a read for ownership, so 4 reals of memory
+// traffic per point.
+
+const int JACOBI_FLOPS_PER_POINT = 7;
+const int JACOBI_REALS_PER_POINT = 4;
+
+inline double jacobi_flops(const int nx, const int ny, const int iterations) {
+  return double(JACOBI_FLOPS_PER_POINT)*(nx-2)*(ny-2)*iterations;
+}
+
+template<typename real>
+double jacobi_bytes(const int nx, const int ny, const int iterations) {
+  return double(JACOBI_REALS_PER_POINT)*sizeof(real)*(nx-2)*(ny-2)*iterations;
+}
+
+inline long cache_size(const int name, const long fallback) {
+  const long size = sysconf(name);
+  return size > 0 ? size : fallback;
+}
+
+struct Roofline {
+  double peak_gflops;  // Single-core peak FMA throughput
+  double l2_gbs;       // Single-core triad bandwidth within L2
+  double l3_gbs;       // ... within L3
+  double dram_gbs;     // ... from memory, as in STREAM
+  long l2_size;
+  long l3_size;
+
+  // The level that holds footprint bytes
+  const char* level(const double footprint) const {
+    return footprint <= l2_size ? "L2" : footprint <= l3_size ? "L3" : "DRAM";
+  }
+
+  double memory_gbs(const double footprint) const {
+    return footprint <= l2_size ? l2_gbs : footprint <= l3_size ? l3_gbs : dram_gbs;
+  }
+
+  double attainable_gflops(const double intensity, const double footprint) const {
+    return std::min(peak_gflops, intensity*memory_gbs(footprint));
+  }
+};
+
+inline double seconds_since(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The STREAM triad a = b + s*c on three arrays of footprint bytes in total,
+// repeated until about 1 GB has moved per sample so that arrays small enough
+// for a cache are still timed over milliseconds. Unlike STREAM, the read for
+// ownership of a is counted, so 4 reals per element, the same accounting as
+// JACOBI_REALS_PER_POINT.
+template<typename real>
+double measure_triad_gbs(const double footprint, const int repeats = 5) {
+  const size_t n = footprint/(3*sizeof(real));
+  const int passes = std::max(1.0, 1e9/(4*sizeof(real)*n));
+  std::vector<real> a(n), b(n, 1.0), c(n, 2.0);
+  const real s = 3.0;
+
+  double best = 1e30;
+  for(int r=0; r<repeats; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    for(int pass=0; pass<passes; ++pass) {
+      for(size_t k=0; k<n; ++k) {
+        a[k] = b[k] + s*c[k];
+      }
+      // Keeps the compiler from collapsing the passes into one
+      asm volatile("" : : "r"(a.data()) : "memory");
+    }
+    best = std::min(best, seconds_since(start));
+    volatile real sink = a[n/2];
+    (void)sink;
+  }
+  return 4.0*sizeof(real)*n*passes/best*1e-9;
+}
+
+#if defined(__AVX512F__)
+const int PEAK_VECTOR_BYTES = 64;
+#elif defined(__AVX__)
+const int PEAK_VECTOR_BYTES = 32;
+#else
+const int PEAK_VECTOR_BYTES = 16;
+#endif
+
+// Independent multiply-add chains in the widest vectors the target has. Two
+// FMA pipes with a latency of 4 to 5 cycles need 8 to 10 chains in flight to
+// stay busy, so 12 covers that and still fits the 16 AVX2 registers. GCC's
+// vector extensions are used because left to itself it prefers 256-bit
+// vectors even where AVX-512 is available.
+template<typename real>
+double measure_peak_gflops(const int repeats = 5) {
+  typedef real vector __attribute__((vector_size(PEAK_VECTOR_BYTES)));
+  const int width = PEAK_VECTOR_BYTES/sizeof(real);
+  const int n_chains = 12;
+  const long iterations = 1<<20;
+  vector acc[n_chains];
+  for(int k=0; k<n_chains; ++k) {
+    for(int l=0; l<width; ++l) acc[k][l] = k*width + l;
+  }
+  const real a = 0.999999;
+  const real b = 1e-7;
+
+  double best = 1e30;
+  for(int r=0; r<repeats; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    for(long it=0; it<iterations; ++it) {
+      for(int k=0; k<n_chains; ++k) {
+        acc[k] = acc[k]*a + b;
+      }
+    }
+    best = std::min(best, seconds_since(start));
+  }
+  real sum = 0.0;
+  for(int k=0; k<n_chains; ++k) {
+    for(int l=0; l<width; ++l) sum += acc[k][l];
+  }
+  volatile real sink = sum;
+  (void)sink;
+  return 2.0*n_chains*width*iterations/best*1e-9;
+}
+
+// Triads filling half of L2, then 8 times L2 or half of L3 if that is
+// smaller, and for memory each array twice the size of L3. The L3 probe stays
+// well inside it because a VM or a busy socket may only get part of a shared
+// L3.
+template<typename real>
+Roofline measure_roofline() {
+  const long l2_size = cache_size(_SC_LEVEL2_CACHE_SIZE, 1L<<20);
+  const long l3_size = cache_size(_SC_LEVEL3_CACHE_SIZE, 64L<<20);
+  return Roofline{measure_peak_gflops<real>(), measure_triad_gbs<real>(l2_size/2), measure_triad_gbs<real>(std::min(8*l2_size, l3_size/2)),
+                  measure_triad_gbs<real>(6.0*l3_size), l2_size, l3_size};
+}
+
+#endif
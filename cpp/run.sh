@@ -4,13 +4,14 @@ set -e
 
 EXE=$1
 REPEATS=$2
+EXTRA_COLUMNS=$3
 
 CSV=${EXE%.x}.csv
 
 echo Running $EXE $REPEATS times
 
 if [ ! -f $CSV ]; then
-  echo "exe_name, language, nx, ny, max_iterations, runtime, average_error" > $CSV
+  echo "exe_name, language, nx, ny, max_iterations, runtime, average_error${EXTRA_COLUMNS}" > $CSV
 fi
 
 for i in $(seq 1 $REPEATS); do
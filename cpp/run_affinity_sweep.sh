@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+
+set -e
+
+EXE=$1
+REPEATS=$2
+EXTRA_COLUMNS=$3
+POLICIES=${POLICIES:-"none compact scatter cores"}
+
+CSV=${EXE%.x}_affinity.csv
+
+echo Running $EXE $REPEATS times with affinity policies $POLICIES
+
+if [ ! -f $CSV ]; then
+  echo "exe_name, language, nx, ny, max_iterations, runtime, average_error${EXTRA_COLUMNS}" > $CSV
+fi
+
+for policy in $POLICIES; do
+  for i in $(seq 1 $REPEATS); do
+    ./$EXE $policy >> $CSV
+  done
+done
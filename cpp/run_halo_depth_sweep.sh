@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+
+set -e
+
+EXE=$1
+REPEATS=$2
+N_PROCS=$3
+EXTRA_COLUMNS=$4
+NX=${5:-128}
+NY=${6:-128}
+MAX_ITERATIONS=${7:-65536}
+HALO_DEPTHS=${HALO_DEPTHS:-"1 2 4 8 16"}
+
+MPIRUN=${MPIRUN:-mpirun}
+
+CSV=${EXE%.x}_halo_depth.csv
+
+echo Running $EXE $REPEATS times on $N_PROCS processes with halo depths $HALO_DEPTHS
+
+if [ ! -f $CSV ]; then
+  echo "exe_name, language, nx, ny, max_iterations, runtime, average_error${EXTRA_COLUMNS}" > $CSV
+fi
+
+for halo_depth in $HALO_DEPTHS; do
+  for i in $(seq 1 $REPEATS); do
+    $MPIRUN $MPIRUN_FLAGS -np $N_PROCS ./$EXE $NX $NY $MAX_ITERATIONS $halo_depth 0 >> $CSV
+  done
+done
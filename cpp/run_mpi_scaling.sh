@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+
+set -e
+
+EXE=$1
+REPEATS=$2
+MAX_PROCS=$3
+EXTRA_COLUMNS=$4
+shift 4 || shift $#
+ARGS=$@
+
+MPIRUN=${MPIRUN:-mpirun}
+
+CSV=${EXE%.x}_scaling.csv
+
+echo Running $EXE $REPEATS times on 1 to $MAX_PROCS processes
+
+if [ ! -f $CSV ]; then
+  echo "exe_name, language, nx, ny, max_iterations, runtime, average_error${EXTRA_COLUMNS}" > $CSV
+fi
+
+n_procs=1
+while [ $n_procs -le $MAX_PROCS ]; do
+  for i in $(seq 1 $REPEATS); do
+    $MPIRUN $MPIRUN_FLAGS -np $n_procs ./$EXE $ARGS >> $CSV
+  done
+  n_procs=$((n_procs*2))
+done
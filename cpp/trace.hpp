@@ -0,0 +1,178 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// A timeline of what each thread spends its time on, written out as Chrome
+// trace JSON, which chrome://tracing and ui.perfetto.dev both open. Each
+// thread records into its own fixed-size ring buffer, so recording an event
+// takes two clock reads and a store, with no locks and no allocation. Once a
+// buffer is full the oldest events are overwritten.
+//
+// The macros compile to nothing unless ENABLE_TRACE is defined:
+//
+//   TRACE_THREAD(name)  names the calling thread and allocates its buffer,
+//                       which would otherwise happen on its first event
+//   TRACE_SCOPE(name)   records the time from here to the end of the scope
+//                       as an event; name must be a string literal
+//   TRACE_DUMP(path)    writes every thread's events to path
+//
+// Dump once the traced threads have finished or are between phases.
+
+struct TraceEvent {
+  const char* name;
+  int64_t start_ns;
+  int64_t end_ns;
+};
+
+class TraceBuffer {
+  public:
+  static const size_t CAPACITY = 1<<16;
+
+  TraceBuffer(const int id_in, const std::string& name_in) :
+    id{id_in}, name{name_in}, count{0}, events(CAPACITY)
+  {}
+
+  void record(const char* event_name, const int64_t start_ns, const int64_t end_ns) {
+    events[count & (CAPACITY-1)] = {event_name, start_ns, end_ns};
+    ++count;
+  }
+
+  size_t recorded() const {return count;}
+  size_t dropped() const {return count > CAPACITY ? count - CAPACITY : 0;}
+
+  int id;
+  std::string name;
+
+  private:
+    friend class TraceRecorder;
+    size_t count;
+    std::vector<TraceEvent> events;
+};
+
+class TraceRecorder {
+  public:
+  static TraceRecorder& instance() {
+    static TraceRecorder recorder;
+    return recorder;
+  }
+
+  int64_t now_ns() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+  }
+
+  // The calling thread's buffer, created on first use
+  TraceBuffer& buffer() {
+    TraceBuffer*& current = current_buffer();
+    if(!current) current = add_buffer("");
+    return *current;
+  }
+
+  void name_thread(const std::string& name) {
+    TraceBuffer& thread_buffer = buffer();
+    std::lock_guard<std::mutex> lock(mutex);
+    thread_buffer.name = name;
+  }
+
+  size_t recorded() {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t total = 0;
+    for(const auto& b : buffers) total += b->recorded();
+    return total;
+  }
+
+  size_t dropped() {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t total = 0;
+    for(const auto& b : buffers) total += b->dropped();
+    return total;
+  }
+
+  // Complete ("X") events in microseconds, plus a name for each thread
+  bool dump(const char* path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    FILE* file = fopen(path, "w");
+    if(!file) {
+      perror("fopen");
+      return false;
+    }
+    fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    bool first = true;
+    for(const auto& b : buffers) {
+      fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+              first ? "" : ",\n", b->id, b->name.c_str());
+      first = false;
+      const size_t n = b->count < TraceBuffer::CAPACITY ? b->count : TraceBuffer::CAPACITY;
+      for(size_t k=b->count-n; k<b->count; ++k) {
+        const TraceEvent& event = b->events[k & (TraceBuffer::CAPACITY-1)];
+        fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                event.name, b->id, event.start_ns/1e3, (event.end_ns - event.start_ns)/1e3);
+      }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    return true;
+  }
+
+  private:
+    TraceRecorder() : epoch{std::chrono::steady_clock::now()} {}
+
+    static TraceBuffer*& current_buffer() {
+      static thread_local TraceBuffer* current = nullptr;
+      return current;
+    }
+
+    TraceBuffer* add_buffer(const std::string& name) {
+      std::lock_guard<std::mutex> lock(mutex);
+      const int id = buffers.size();
+      buffers.emplace_back(new TraceBuffer(id, name.empty() ? "thread " + std::to_string(id) : name));
+      return buffers.back().get();
+    }
+
+    std::chrono::steady_clock::time_point epoch;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+};
+
+class TraceScope {
+  public:
+  explicit TraceScope(const char* name_in) :
+    buffer(TraceRecorder::instance().buffer()),
+    name{name_in},
+    start_ns{TraceRecorder::instance().now_ns()}
+  {}
+
+  ~TraceScope() {
+    buffer.record(name, start_ns, TraceRecorder::instance().now_ns());
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+  private:
+    TraceBuffer& buffer;
+    const char* name;
+    int64_t start_ns;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef ENABLE_TRACE
+#define TRACE_THREAD(name) TraceRecorder::instance().name_thread(name)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_DUMP(path) TraceRecorder::instance().dump(path)
+#else
+// sizeof leaves the argument unevaluated but still counts as a use of it
+#define TRACE_THREAD(name) do {(void)sizeof(name);} while(0)
+#define TRACE_SCOPE(name) do {} while(0)
+#define TRACE_DUMP(path) do {(void)sizeof(path);} while(0)
+#endif
+
+#endif
@@ -0,0 +1,229 @@
+#include <mpi.h>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+using std::vector;
+
+typedef PRECISION real;
+
+const MPI_Datatype MPI_REAL_TYPE = sizeof(real) == sizeof(double) ? MPI_DOUBLE : MPI_FLOAT;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(nx_in*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  int idx(int i, int j) const {return j + i*ny;}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// Each rank owns a contiguous block of interior rows plus one halo row above
+// and below. Ranks at the edge of the domain use MPI_PROC_NULL as their
+// neighbour, so their halo row is the (fixed) global boundary.
+struct Decomposition {
+  Decomposition(int nx, int rank, int size) {
+    const int n_interior = nx-2;
+    const int base = n_interior/size;
+    const int rem = n_interior%size;
+    local_nx = base + (rank < rem);
+    i_start = 1 + rank*base + (rank < rem ? rank : rem);
+    below = rank > 0 ? rank-1 : MPI_PROC_NULL;
+    above = rank < size-1 ? rank+1 : MPI_PROC_NULL;
+  }
+
+  int local_nx; // Number of owned rows
+  int i_start;  // Global index of first owned row
+  int below;
+  int above;
+};
+
+void exchange_halos(Array& p, const int below, const int above) {
+  MPI_Sendrecv(&p(1,0), p.ny, MPI_REAL_TYPE, below, 0,
+               &p(p.nx-1,0), p.ny, MPI_REAL_TYPE, above, 0,
+               MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  MPI_Sendrecv(&p(p.nx-2,0), p.ny, MPI_REAL_TYPE, above, 1,
+               &p(0,0), p.ny, MPI_REAL_TYPE, below, 1,
+               MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+}
+
+// Time of a blocking halo exchange on its own, used to estimate how much of
+// the exchange the overlapped solver manages to hide behind computation
+double time_blocking_exchange(Array& p, const int below, const int above, const int n_repeats) {
+  MPI_Barrier(MPI_COMM_WORLD);
+  double start = MPI_Wtime();
+  for(int n=0; n<n_repeats; ++n) {
+    exchange_halos(p, below, above);
+  }
+  return (MPI_Wtime() - start)/n_repeats;
+}
+
+struct CommTimes {
+  double exposed = 0.0; // Total time spent waiting for the exchange to finish
+};
+
+inline void sweep_rows(Array& p_new, const Array& p, const Array& b, const int i_begin, const int i_end, const real D_x, const real D_y, const real B) {
+  for(int i=i_begin; i<i_end; ++i) {
+    for(int j=1; j<p.ny-1; ++j) {
+      p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+    }
+  }
+}
+
+// The owned boundary rows are updated first and their exchange is posted
+// straight away; the interior rows are then swept while the messages are in
+// flight, and only the remaining wait is exposed.
+void run_jacobi(Array& p, const Array& b, const real dx, const real dy, const int max_iterations, const int below, const int above, CommTimes& times) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  const int first = 1;
+  const int last = p.nx-2;
+
+  Array p_new(p.nx,p.ny);
+  MPI_Request requests[4];
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    sweep_rows(p_new, p, b, first, first+1, D_x, D_y, B);
+    if(last != first) {
+      sweep_rows(p_new, p, b, last, last+1, D_x, D_y, B);
+    }
+
+    MPI_Irecv(&p_new(0,0), p.ny, MPI_REAL_TYPE, below, 1, MPI_COMM_WORLD, &requests[0]);
+    MPI_Irecv(&p_new(p.nx-1,0), p.ny, MPI_REAL_TYPE, above, 0, MPI_COMM_WORLD, &requests[1]);
+    MPI_Isend(&p_new(first,0), p.ny, MPI_REAL_TYPE, below, 0, MPI_COMM_WORLD, &requests[2]);
+    MPI_Isend(&p_new(last,0), p.ny, MPI_REAL_TYPE, above, 1, MPI_COMM_WORLD, &requests[3]);
+
+    sweep_rows(p_new, p, b, first+1, last, D_x, D_y, B);
+
+    double wait_start = MPI_Wtime();
+    MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+    times.exposed += MPI_Wtime() - wait_start;
+
+    std::swap(p, p_new);
+  }
+}
+
+void gather_rows(Array& p_global, const Array& p_local, const Decomposition& dec, const int rank, const int size) {
+  vector<int> counts(size), displs(size);
+  const int count = dec.local_nx*p_local.ny;
+  const int displ = dec.i_start*p_local.ny;
+  MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Gather(&displ, 1, MPI_INT, displs.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Gatherv(&p_local(1,0), count, MPI_REAL_TYPE,
+              rank == 0 ? &p_global(0,0) : nullptr, counts.data(), displs.data(), MPI_REAL_TYPE,
+              0, MPI_COMM_WORLD);
+}
+
+int main(int argc, char* argv[]) {
+  MPI_Init(&argc, &argv);
+
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  const int NX = argc > 1 ? atoi(argv[1]) : 128;
+  const int NY = argc > 2 ? atoi(argv[2]) : 128;
+  const int MAX_ITERATIONS = argc > 3 ? atoi(argv[3]) : 1<<16;
+  const bool VERIFY = argc > 4 ? atoi(argv[4]) : true;
+
+  if(NX-2 < size) {
+    if(rank == 0) fprintf(stderr, "Cannot split %d interior rows over %d processes\n", NX-2, size);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  Decomposition dec(NX, rank, size);
+
+  Array p(dec.local_nx+2, NY);
+  Array b(dec.local_nx+2, NY);
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  for(int li=0; li<p.nx; ++li) {
+    for(int j=0; j<NY; ++j) {
+      real x = (dec.i_start-1+li)*dx;
+      real y = j*dx;
+
+      b(li,j) = sin(M_PI*x)*sin(M_PI*y);
+      p(li,j) = 0.0;
+    }
+  }
+
+  const double t_exchange = time_blocking_exchange(p, dec.below, dec.above, 1000);
+
+  CommTimes times;
+  MPI_Barrier(MPI_COMM_WORLD);
+  double start = MPI_Wtime();
+  run_jacobi(p, b, dx, dy, MAX_ITERATIONS, dec.below, dec.above, times);
+  MPI_Barrier(MPI_COMM_WORLD);
+  double diff = MPI_Wtime() - start;
+
+  int msec = diff * 1000;
+
+  // Per-iteration times in microseconds, taken from the slowest rank
+  double comm_times[2] = {t_exchange*1e6, times.exposed*1e6/MAX_ITERATIONS};
+  double max_comm_times[2];
+  MPI_Reduce(comm_times, max_comm_times, 2, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  const double exposed_us = max_comm_times[1];
+  const double hidden_us = fmax(max_comm_times[0] - exposed_us, 0.0);
+
+  // The error is computed serially on the gathered solution so that it is
+  // summed in exactly the same order as the single-process versions
+  Array p_global(rank == 0 ? NX : 0, NY);
+  gather_rows(p_global, p, dec, rank, size);
+
+  int status = 0;
+  if(rank == 0) {
+    Array b_global(NX, NY);
+    Array p_soln(NX, NY);
+    for(int i=0; i<NX; ++i) {
+      for(int j=0; j<NY; ++j) {
+        real x = i*dx;
+        real y = j*dx;
+
+        b_global(i,j) = sin(M_PI*x)*sin(M_PI*y);
+        p_soln(i,j) = -sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI);
+      }
+    }
+
+    real av_error = 0.0;
+    for(int i=1; i<NX-1; ++i) {
+      for(int j=1; j<NY-1; ++j) {
+        av_error += fabs(p_global(i,j) - p_soln(i,j));
+      }
+    }
+    av_error /= (NX*NY);
+
+    if(VERIFY) {
+      Array p_ref(NX, NY);
+      CommTimes ref_times;
+      run_jacobi(p_ref, b_global, dx, dy, MAX_ITERATIONS, MPI_PROC_NULL, MPI_PROC_NULL, ref_times);
+
+      real max_diff = 0.0;
+      for(int i=0; i<NX; ++i) {
+        for(int j=0; j<NY; ++j) {
+          max_diff = fmax(max_diff, fabs(p_global(i,j) - p_ref(i,j)));
+        }
+      }
+      if(max_diff != 0.0) {
+        fprintf(stderr, "Decomposed solution differs from single-process solution by %e\n", max_diff);
+        status = 1;
+      }
+    }
+
+    printf("%s, cpp, %d, %d, %d, %d, %e, %d, %f, %f\n", argv[0], NX, NY, MAX_ITERATIONS, msec, av_error, size, hidden_us, exposed_us);
+  }
+
+  MPI_Finalize();
+  return status;
+}
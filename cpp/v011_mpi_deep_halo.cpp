@@ -0,0 +1,215 @@
+#include <mpi.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+using std::vector;
+
+typedef PRECISION real;
+
+const MPI_Datatype MPI_REAL_TYPE = sizeof(real) == sizeof(double) ? MPI_DOUBLE : MPI_FLOAT;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(nx_in*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  int idx(int i, int j) const {return j + i*ny;}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// Each rank owns a contiguous block of interior rows plus NG halo rows above
+// and below. Ranks at the edge of the domain use MPI_PROC_NULL as their
+// neighbour; their halo holds the (fixed) global boundary row and a few unused
+// rows that lie outside the domain.
+struct Decomposition {
+  Decomposition(int nx, int ng_in, int rank, int size) :
+    ng{ng_in}
+  {
+    const int n_interior = nx-2;
+    const int base = n_interior/size;
+    const int rem = n_interior%size;
+    local_nx = base + (rank < rem);
+    i_start = 1 + rank*base + (rank < rem ? rank : rem);
+    below = rank > 0 ? rank-1 : MPI_PROC_NULL;
+    above = rank < size-1 ? rank+1 : MPI_PROC_NULL;
+    // Local rows that map onto global interior rows 1 to nx-2
+    interior_begin = std::max(1 - (i_start-ng), 0);
+    interior_end = std::min(nx-1 - (i_start-ng), local_nx+2*ng);
+  }
+
+  int ng;       // Halo depth
+  int local_nx; // Number of owned rows
+  int i_start;  // Global index of first owned row
+  int below;
+  int above;
+  int interior_begin;
+  int interior_end;
+};
+
+void exchange_halos(Array& p, const Decomposition& dec) {
+  const int ng = dec.ng;
+  const int count = ng*p.ny;
+  MPI_Sendrecv(&p(ng,0), count, MPI_REAL_TYPE, dec.below, 0,
+               &p(ng+dec.local_nx,0), count, MPI_REAL_TYPE, dec.above, 0,
+               MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  MPI_Sendrecv(&p(dec.local_nx,0), count, MPI_REAL_TYPE, dec.above, 1,
+               &p(0,0), count, MPI_REAL_TYPE, dec.below, 1,
+               MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+}
+
+// Halos are exchanged once every NG sweeps. Between exchanges each sweep
+// also updates the part of the halo that is still valid, which shrinks by one
+// row on each side per sweep, so that the owned rows are correct after NG
+// sweeps. Returns the number of row updates done.
+long run_jacobi(Array& p, const Array& b, const real dx, const real dy, const int max_iterations, const Decomposition& dec) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  const int ng = dec.ng;
+  long row_updates = 0;
+
+  Array p_new(p.nx,p.ny);
+  for(int iter = 0; iter<max_iterations; iter+=ng) {
+    exchange_halos(p, dec);
+    const int n_sweeps = std::min(ng, max_iterations-iter);
+    for(int sweep=0; sweep<n_sweeps; ++sweep) {
+      const int i_begin = std::max(1+sweep, dec.interior_begin);
+      const int i_end = std::min(p.nx-1-sweep, dec.interior_end);
+      for(int i=i_begin; i<i_end; ++i) {
+        for(int j=1; j<p.ny-1; ++j) {
+          p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+        }
+      }
+      row_updates += i_end - i_begin;
+      std::swap(p, p_new);
+    }
+  }
+  return row_updates;
+}
+
+void gather_rows(Array& p_global, const Array& p_local, const Decomposition& dec, const int rank, const int size) {
+  vector<int> counts(size), displs(size);
+  const int count = dec.local_nx*p_local.ny;
+  const int displ = dec.i_start*p_local.ny;
+  MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Gather(&displ, 1, MPI_INT, displs.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Gatherv(&p_local(dec.ng,0), count, MPI_REAL_TYPE,
+              rank == 0 ? &p_global(0,0) : nullptr, counts.data(), displs.data(), MPI_REAL_TYPE,
+              0, MPI_COMM_WORLD);
+}
+
+int main(int argc, char* argv[]) {
+  MPI_Init(&argc, &argv);
+
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  const int NX = argc > 1 ? atoi(argv[1]) : 128;
+  const int NY = argc > 2 ? atoi(argv[2]) : 128;
+  const int MAX_ITERATIONS = argc > 3 ? atoi(argv[3]) : 1<<16;
+  const int NG = argc > 4 ? atoi(argv[4]) : 4;
+  const bool VERIFY = argc > 5 ? atoi(argv[5]) : true;
+
+  // The halo is filled from the neighbour's owned rows, so it can't be deeper
+  // than the smallest block
+  if(NG < 1) {
+    if(rank == 0) fprintf(stderr, "Halo depth must be at least 1, got %d\n", NG);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  if((NX-2)/size < NG) {
+    if(rank == 0) fprintf(stderr, "Cannot split %d interior rows over %d processes with halo depth %d\n", NX-2, size, NG);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  Decomposition dec(NX, NG, rank, size);
+
+  Array p(dec.local_nx+2*NG, NY);
+  Array b(dec.local_nx+2*NG, NY);
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  for(int li=0; li<p.nx; ++li) {
+    for(int j=0; j<NY; ++j) {
+      real x = (dec.i_start-NG+li)*dx;
+      real y = j*dx;
+
+      b(li,j) = sin(M_PI*x)*sin(M_PI*y);
+      p(li,j) = 0.0;
+    }
+  }
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  double start = MPI_Wtime();
+  long row_updates = run_jacobi(p, b, dx, dy, MAX_ITERATIONS, dec);
+  MPI_Barrier(MPI_COMM_WORLD);
+  double diff = MPI_Wtime() - start;
+
+  int msec = diff * 1000;
+
+  long total_row_updates;
+  MPI_Reduce(&row_updates, &total_row_updates, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+  const double redundant_fraction = double(total_row_updates)/(double(NX-2)*MAX_ITERATIONS) - 1.0;
+
+  // The error is computed serially on the gathered solution so that it is
+  // summed in exactly the same order as the single-process versions
+  Array p_global(rank == 0 ? NX : 0, NY);
+  gather_rows(p_global, p, dec, rank, size);
+
+  int status = 0;
+  if(rank == 0) {
+    Array b_global(NX, NY);
+    Array p_soln(NX, NY);
+    for(int i=0; i<NX; ++i) {
+      for(int j=0; j<NY; ++j) {
+        real x = i*dx;
+        real y = j*dx;
+
+        b_global(i,j) = sin(M_PI*x)*sin(M_PI*y);
+        p_soln(i,j) = -sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI);
+      }
+    }
+
+    real av_error = 0.0;
+    for(int i=1; i<NX-1; ++i) {
+      for(int j=1; j<NY-1; ++j) {
+        av_error += fabs(p_global(i,j) - p_soln(i,j));
+      }
+    }
+    av_error /= (NX*NY);
+
+    if(VERIFY) {
+      Array p_ref(NX, NY);
+      run_jacobi(p_ref, b_global, dx, dy, MAX_ITERATIONS, Decomposition(NX, 1, 0, 1));
+
+      real max_diff = 0.0;
+      for(int i=0; i<NX; ++i) {
+        for(int j=0; j<NY; ++j) {
+          max_diff = fmax(max_diff, fabs(p_global(i,j) - p_ref(i,j)));
+        }
+      }
+      if(max_diff != 0.0) {
+        fprintf(stderr, "Decomposed solution differs from single-process solution by %e\n", max_diff);
+        status = 1;
+      }
+    }
+
+    printf("%s, cpp, %d, %d, %d, %d, %e, %d, %d, %f\n", argv[0], NX, NY, MAX_ITERATIONS, msec, av_error, size, NG, redundant_fraction);
+  }
+
+  MPI_Finalize();
+  return status;
+}
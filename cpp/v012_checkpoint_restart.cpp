@@ -0,0 +1,378 @@
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using std::vector;
+
+typedef PRECISION real;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(nx_in*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  int idx(int i, int j) const {return j + i*ny;}
+  real* begin() {return data.data();}
+  const real* begin() const {return data.data();}
+  int size() const {return nx*ny;}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// Lossless compression of a field: each value is predicted by linear
+// extrapolation from the previous two and XORed with its prediction, which for
+// a smooth field zeroes the sign, exponent and leading mantissa bytes. Each
+// value is stored as a count of leading zero bytes followed by the remaining
+// bytes.
+typedef std::conditional<sizeof(real) == 8, uint64_t, uint32_t>::type real_bits;
+
+size_t max_compressed_size(const int n) {return n*(sizeof(real_bits)+1);}
+
+inline real_bits to_bits(const real x) {
+  real_bits bits;
+  memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+size_t compress(uint8_t* out, const real* in, const int n) {
+  uint8_t* start = out;
+  real prev[2] = {0.0, 0.0};
+  for(int k=0; k<n; ++k) {
+    real_bits x = to_bits(in[k]) ^ to_bits(2*prev[1] - prev[0]);
+    prev[0] = prev[1];
+    prev[1] = in[k];
+    int n_zero = x == 0 ? sizeof(x) : __builtin_clzll(x)/8 - (8-sizeof(x));
+    *out++ = n_zero;
+    for(unsigned b=0; b<sizeof(x)-n_zero; ++b) {
+      *out++ = (x >> (8*b)) & 0xff;
+    }
+  }
+  return out - start;
+}
+
+void decompress(real* out, const uint8_t* in, const int n) {
+  real prev[2] = {0.0, 0.0};
+  for(int k=0; k<n; ++k) {
+    int n_zero = *in++;
+    real_bits x = 0;
+    for(unsigned b=0; b<sizeof(x)-n_zero; ++b) {
+      x |= real_bits(*in++) << (8*b);
+    }
+    x ^= to_bits(2*prev[1] - prev[0]);
+    memcpy(&out[k], &x, sizeof(x));
+    prev[0] = prev[1];
+    prev[1] = out[k];
+  }
+}
+
+// The checkpoint file holds a header followed by two slots. A new checkpoint
+// is always written to the slot not referenced by the header, and the header
+// is only switched over once the slot is on disk, so a job killed part way
+// through a write can still restart from the previous checkpoint.
+struct CheckpointHeader {
+  char magic[8];
+  int32_t real_size;
+  int32_t nx;
+  int32_t ny;
+  int32_t max_iterations;
+  double dx;
+  double dy;
+  int32_t compressed;
+  int32_t valid_slot; // -1 if no checkpoint has been written yet
+  uint64_t slot_size;
+  int64_t iteration[2];
+  uint64_t payload_size[2];
+};
+
+const char CHECKPOINT_MAGIC[8] = {'J','A','C','O','B','I','C','K'};
+const size_t HEADER_SIZE = 4096;
+
+class Checkpoint {
+  public:
+  // Maps an existing checkpoint for the same problem, or creates a new one
+  Checkpoint(const char* filename_in, const Array& p, const real dx, const real dy, const int max_iterations, const bool compressed) :
+    filename{filename_in}
+  {
+    // Slots are page aligned so that each one can be synced on its own
+    const size_t payload_size = compressed ? max_compressed_size(p.size()) : p.size()*sizeof(real);
+    const size_t slot_size = (payload_size + HEADER_SIZE - 1)/HEADER_SIZE*HEADER_SIZE;
+    file_size = HEADER_SIZE + 2*slot_size;
+
+    fd = open(filename, O_RDWR | O_CREAT, 0644);
+    if(fd < 0) {
+      perror("open");
+      exit(1);
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+      perror("fstat");
+      exit(1);
+    }
+    const bool exists = size_t(st.st_size) == file_size;
+    if(!exists && ftruncate(fd, file_size) != 0) {
+      perror("ftruncate");
+      exit(1);
+    }
+    map = static_cast<uint8_t*>(mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+    if(map == MAP_FAILED) {
+      perror("mmap");
+      exit(1);
+    }
+    header = reinterpret_cast<CheckpointHeader*>(map);
+
+    const bool matches = exists
+      && memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) == 0
+      && header->real_size == sizeof(real) && header->nx == p.nx && header->ny == p.ny
+      && header->max_iterations == max_iterations && header->compressed == compressed;
+    if(!matches) {
+      memset(header, 0, sizeof(CheckpointHeader));
+      memcpy(header->magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+      header->real_size = sizeof(real);
+      header->nx = p.nx;
+      header->ny = p.ny;
+      header->max_iterations = max_iterations;
+      header->dx = dx;
+      header->dy = dy;
+      header->compressed = compressed;
+      header->valid_slot = -1;
+      header->slot_size = slot_size;
+      msync(map, HEADER_SIZE, MS_SYNC);
+    }
+  }
+
+  ~Checkpoint() {
+    munmap(map, file_size);
+    close(fd);
+  }
+
+  // Loads the last complete checkpoint into p and returns its iteration, or 0
+  int restore(Array& p) const {
+    const int slot = header->valid_slot;
+    if(slot < 0) return 0;
+    const uint8_t* payload = map + HEADER_SIZE + slot*header->slot_size;
+    if(header->compressed) {
+      decompress(p.begin(), payload, p.size());
+    } else {
+      memcpy(p.begin(), payload, p.size()*sizeof(real));
+    }
+    return header->iteration[slot];
+  }
+
+  void write(const Array& p, const int iteration) {
+    const int slot = header->valid_slot == 0 ? 1 : 0;
+    uint8_t* payload = map + HEADER_SIZE + slot*header->slot_size;
+    size_t payload_size;
+    if(header->compressed) {
+      payload_size = compress(payload, p.begin(), p.size());
+    } else {
+      payload_size = p.size()*sizeof(real);
+      memcpy(payload, p.begin(), payload_size);
+    }
+    msync(payload, header->slot_size, MS_SYNC);
+
+    header->iteration[slot] = iteration;
+    header->payload_size[slot] = payload_size;
+    header->valid_slot = slot;
+    msync(map, HEADER_SIZE, MS_SYNC);
+  }
+
+  void remove() const {unlink(filename);}
+
+  size_t payload_size() const {return header->valid_slot < 0 ? 0 : header->payload_size[header->valid_slot];}
+
+  private:
+    const char* filename;
+    int fd;
+    size_t file_size;
+    uint8_t* map;
+    CheckpointHeader* header;
+};
+
+// Compressing and syncing a checkpoint happens on a background thread. The
+// solver only copies p into a staging buffer, and skips the checkpoint
+// entirely if the previous one is still being written.
+class CheckpointWriter {
+  public:
+  CheckpointWriter(Checkpoint& checkpoint_in, const Array& p) :
+    checkpoint{checkpoint_in},
+    staging(p.nx, p.ny),
+    thread{&CheckpointWriter::run, this}
+  {}
+
+  ~CheckpointWriter() {finish();}
+
+  // Waits for a checkpoint being written to complete and stops the thread.
+  // The counters are only final after this.
+  void finish() {
+    if(!thread.joinable()) return;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished = true;
+    }
+    ready.notify_one();
+    thread.join();
+  }
+
+  void submit(const Array& p, const int iteration) {
+    if(busy.load(std::memory_order_acquire)) {
+      ++n_skipped;
+      return;
+    }
+    memcpy(staging.begin(), p.begin(), p.size()*sizeof(real));
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      staged_iteration = iteration;
+      busy.store(true, std::memory_order_release);
+    }
+    ready.notify_one();
+  }
+
+  // Written by the writer thread and the solver thread respectively
+  std::atomic<int> n_written{0};
+  std::atomic<int> n_skipped{0};
+
+  private:
+    void run() {
+      std::unique_lock<std::mutex> lock(mutex);
+      while(true) {
+        ready.wait(lock, [this]{return busy.load() || finished;});
+        if(busy.load()) {
+          lock.unlock();
+          checkpoint.write(staging, staged_iteration);
+          ++n_written;
+          lock.lock();
+          busy.store(false, std::memory_order_release);
+        } else if(finished) {
+          return;
+        }
+      }
+    }
+
+    Checkpoint& checkpoint;
+    Array staging;
+    int staged_iteration = 0;
+    std::atomic<bool> busy{false};
+    bool finished = false;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::thread thread;
+};
+
+void run_jacobi(Array& p, const Array& b, const real dx, const real dy, const int start_iteration, const int max_iterations, CheckpointWriter* writer, const int checkpoint_interval) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  Array p_new(p.nx,p.ny);
+  for(int iter = start_iteration; iter<max_iterations; ++iter) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+    if(writer && (iter+1)%checkpoint_interval == 0) {
+      writer->submit(p, iter+1);
+    }
+  }
+}
+
+double elapsed_ms(const timespec& start, const timespec& end) {
+  return (end.tv_sec - start.tv_sec)*1e3 + (end.tv_nsec - start.tv_nsec)*1e-6;
+}
+
+int main(int argc, char* argv[]) {
+  const int NX = 128;
+  const int NY = 128;
+  const int MAX_ITERATIONS = 1<<16;
+  const int CHECKPOINT_INTERVAL = argc > 1 ? atoi(argv[1]) : 4096;
+  const bool COMPRESS = argc > 2 ? atoi(argv[2]) : true;
+  const std::string checkpoint_file = argc > 3 ? argv[3] : std::string(argv[0]) + ".chk";
+  if(CHECKPOINT_INTERVAL < 1) {
+    fprintf(stderr, "Checkpoint interval must be at least 1, got %d\n", CHECKPOINT_INTERVAL);
+    return 1;
+  }
+
+  Array p(NX, NY);
+  Array b(NX, NY);
+  Array p_soln(NX, NY);
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  for(int i=0; i<NX; ++i) {
+    for(int j=0; j<NY; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+
+      b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+      p_soln(i,j) = -sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI);
+      p(i,j) = 0.0;
+    }
+  }
+
+  Checkpoint checkpoint(checkpoint_file.c_str(), p, dx, dy, MAX_ITERATIONS, COMPRESS);
+  const int start_iteration = checkpoint.restore(p);
+
+  // Solve once without checkpointing, from the same starting point, to
+  // measure the overhead against
+  Array p_ref = p;
+
+  timespec start, end;
+  int n_written, n_skipped;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  {
+    CheckpointWriter writer(checkpoint, p);
+    run_jacobi(p, b, dx, dy, start_iteration, MAX_ITERATIONS, &writer, CHECKPOINT_INTERVAL);
+    writer.finish();
+    n_written = writer.n_written;
+    n_skipped = writer.n_skipped;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  const double msec = elapsed_ms(start, end);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  run_jacobi(p_ref, b, dx, dy, start_iteration, MAX_ITERATIONS, nullptr, CHECKPOINT_INTERVAL);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  const double ref_msec = elapsed_ms(start, end);
+
+  const double overhead = ref_msec > 0.0 ? 100.0*(msec - ref_msec)/ref_msec : 0.0;
+  const double compression_ratio = checkpoint.payload_size() > 0 ? double(NX*NY*sizeof(real))/checkpoint.payload_size() : 0.0;
+
+  // The solve finished, so there is nothing left to restart from
+  checkpoint.remove();
+
+  real av_error = 0.0;
+  for(int i=1; i<NX-1; ++i) {
+    for(int j=1; j<NY-1; ++j) {
+      av_error += fabs(p(i,j) - p_soln(i,j));
+    }
+  }
+  av_error /= (NX*NY);
+
+  printf("%s, cpp, %d, %d, %d, %d, %e, %d, %d, %d, %d, %f, %f\n", argv[0], NX, NY, MAX_ITERATIONS, int(msec), av_error,
+         start_iteration, CHECKPOINT_INTERVAL, n_written, n_skipped, compression_ratio, overhead);
+
+  return 0;
+}
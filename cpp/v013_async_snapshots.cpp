@@ -0,0 +1,290 @@
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+using std::vector;
+
+typedef PRECISION real;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(nx_in*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  int idx(int i, int j) const {return j + i*ny;}
+  real* begin() {return data.data();}
+  const real* begin() const {return data.data();}
+  int size() const {return nx*ny;}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// Lock-free queue between exactly one producer and one consumer thread. The
+// producer only writes tail and the consumer only writes head, so neither
+// ever waits on the other.
+template<typename T, int N>
+class SpscQueue {
+  public:
+  bool push(const T& item) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if(tail - head_.load(std::memory_order_acquire) == N) return false;
+    items[tail%N] = item;
+    tail_.store(tail+1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T& item) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if(head == tail_.load(std::memory_order_acquire)) return false;
+    item = items[head%N];
+    head_.store(head+1, std::memory_order_release);
+    return true;
+  }
+
+  // Only meaningful on the consumer side
+  bool empty() const {
+    return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+  }
+
+  private:
+    T items[N];
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+// Self-describing snapshot header, padded to 64 bytes so the field that
+// follows it stays aligned
+struct SnapshotHeader {
+  char magic[8];
+  int32_t real_size;
+  int32_t nx;
+  int32_t ny;
+  int32_t iteration;
+  char padding[40];
+};
+
+const char SNAPSHOT_MAGIC[8] = {'J','A','C','O','B','I','S','N'};
+
+struct Snapshot {
+  Snapshot(int nx, int ny) : field(nx, ny) {}
+  int iteration = 0;
+  Array field;
+};
+
+const int POOL_SIZE = 4;
+
+// The solver takes a free buffer from the pool, copies p into it and hands it
+// to the writer thread, which writes it out and returns it to the pool. If no
+// buffer is free the snapshot is dropped rather than stalling the solver. The
+// writer sleeps on a condition variable while there is nothing to write, so
+// it doesn't compete with the solver for the CPU; the solver only briefly
+// takes the uncontended mutex to wake it.
+class SnapshotStream {
+  public:
+  SnapshotStream(const char* filename, const Array& p, const bool self_describing_in) :
+    self_describing{self_describing_in}
+  {
+    file = fopen(filename, "wb");
+    if(!file) {
+      perror("fopen");
+      exit(1);
+    }
+    pool.reserve(POOL_SIZE);
+    for(int n=0; n<POOL_SIZE; ++n) {
+      pool.emplace_back(p.nx, p.ny);
+      free_buffers.push(&pool[n]);
+    }
+    thread = std::thread(&SnapshotStream::run, this);
+  }
+
+  ~SnapshotStream() {close();}
+
+  // Waits for the writer to drain any queued snapshots
+  void close() {
+    if(!file) return;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished = true;
+    }
+    ready.notify_one();
+    thread.join();
+    fclose(file);
+    file = nullptr;
+  }
+
+  void submit(const Array& p, const int iteration) {
+    Snapshot* snapshot;
+    if(!free_buffers.pop(snapshot)) {
+      ++n_dropped;
+      return;
+    }
+    memcpy(snapshot->field.begin(), p.begin(), p.size()*sizeof(real));
+    snapshot->iteration = iteration;
+    full_buffers.push(snapshot);
+    // Taking the lock orders the push with the writer's check for work, so
+    // the notification can't be missed
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+    }
+    ready.notify_one();
+  }
+
+  int n_dropped = 0;
+  std::atomic<int> n_written{0};
+
+  private:
+    void run() {
+      while(true) {
+        Snapshot* snapshot;
+        if(full_buffers.pop(snapshot)) {
+          write(*snapshot);
+          free_buffers.push(snapshot);
+          n_written.fetch_add(1, std::memory_order_relaxed);
+          continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [&]{return finished || !full_buffers.empty();});
+        if(finished) {
+          lock.unlock();
+          // The solver has stopped, so anything still queued is already visible
+          while(full_buffers.pop(snapshot)) {
+            write(*snapshot);
+            n_written.fetch_add(1, std::memory_order_relaxed);
+          }
+          return;
+        }
+      }
+    }
+
+    void write(const Snapshot& snapshot) {
+      if(self_describing) {
+        SnapshotHeader header = {};
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.real_size = sizeof(real);
+        header.nx = snapshot.field.nx;
+        header.ny = snapshot.field.ny;
+        header.iteration = snapshot.iteration;
+        fwrite(&header, sizeof(header), 1, file);
+      }
+      fwrite(snapshot.field.begin(), sizeof(real), snapshot.field.size(), file);
+    }
+
+    bool self_describing;
+    FILE* file;
+    vector<Snapshot> pool;
+    SpscQueue<Snapshot*, POOL_SIZE> free_buffers;
+    SpscQueue<Snapshot*, POOL_SIZE> full_buffers;
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool finished = false;
+    std::thread thread;
+};
+
+void run_jacobi(Array& p, const Array& b, const real dx, const real dy, const int max_iterations, SnapshotStream* stream, const int snapshot_interval) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  Array p_new(p.nx,p.ny);
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+    if(stream && (iter+1)%snapshot_interval == 0) {
+      stream->submit(p, iter+1);
+    }
+  }
+}
+
+double elapsed_ms(const timespec& start, const timespec& end) {
+  return (end.tv_sec - start.tv_sec)*1e3 + (end.tv_nsec - start.tv_nsec)*1e-6;
+}
+
+int main(int argc, char* argv[]) {
+  const int NX = 128;
+  const int NY = 128;
+  const int MAX_ITERATIONS = 1<<16;
+  const bool SELF_DESCRIBING = argc > 1 ? atoi(argv[1]) : true;
+  const std::string snapshot_file = argc > 2 ? argv[2] : std::string(argv[0]) + ".snap";
+  // Snapshot cadences to benchmark, 0 being no snapshots at all
+  vector<int> snapshot_intervals = {0, 4096, 1024, 256, 64, 16};
+  if(argc > 3) {
+    snapshot_intervals.clear();
+    for(int n=3; n<argc; ++n) {
+      snapshot_intervals.push_back(atoi(argv[n]));
+    }
+  }
+
+  Array b(NX, NY);
+  Array p_soln(NX, NY);
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  for(int i=0; i<NX; ++i) {
+    for(int j=0; j<NY; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+
+      b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+      p_soln(i,j) = -sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI);
+    }
+  }
+
+  for(const int snapshot_interval : snapshot_intervals) {
+    Array p(NX, NY);
+
+    timespec start, end;
+    int n_written = 0, n_dropped = 0;
+    double msec;
+    if(snapshot_interval > 0) {
+      SnapshotStream stream(snapshot_file.c_str(), p, SELF_DESCRIBING);
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      run_jacobi(p, b, dx, dy, MAX_ITERATIONS, &stream, snapshot_interval);
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      msec = elapsed_ms(start, end);
+      stream.close();
+      n_written = stream.n_written;
+      n_dropped = stream.n_dropped;
+    } else {
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      run_jacobi(p, b, dx, dy, MAX_ITERATIONS, nullptr, 1);
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      msec = elapsed_ms(start, end);
+    }
+
+    const double mupdates_per_sec = double(NX-2)*(NY-2)*MAX_ITERATIONS/(msec*1e3);
+
+    real av_error = 0.0;
+    for(int i=1; i<NX-1; ++i) {
+      for(int j=1; j<NY-1; ++j) {
+        av_error += fabs(p(i,j) - p_soln(i,j));
+      }
+    }
+    av_error /= (NX*NY);
+
+    printf("%s, cpp, %d, %d, %d, %d, %e, %d, %d, %d, %f\n", argv[0], NX, NY, MAX_ITERATIONS, int(msec), av_error,
+           snapshot_interval, n_written, n_dropped, mupdates_per_sec);
+  }
+
+  return 0;
+}
@@ -0,0 +1,224 @@
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using std::vector;
+
+typedef PRECISION real;
+
+// Field files use the same 64-byte header as the snapshots written by V013,
+// so any single snapshot can be loaded as an input
+struct FieldHeader {
+  char magic[8];
+  int32_t real_size;
+  int32_t nx;
+  int32_t ny;
+  int32_t iteration;
+  char padding[40];
+};
+
+const char FIELD_MAGIC[8] = {'J','A','C','O','B','I','S','N'};
+
+// Owns a mapping of a whole file and unmaps it on destruction
+class Mapping {
+  public:
+  Mapping() {}
+  Mapping(void* addr_in, size_t length_in) : addr{addr_in}, length{length_in} {}
+  Mapping(Mapping&& other) : addr{other.addr}, length{other.length} {other.addr = nullptr;}
+  Mapping& operator=(Mapping&& other) {std::swap(addr, other.addr); std::swap(length, other.length); return *this;}
+  ~Mapping() {if(addr) munmap(addr, length);}
+
+  void* addr = nullptr;
+  size_t length = 0;
+};
+
+// The data of an Array either lives in its own vector or, when mapped from a
+// file, directly in the page cache. A read-only mapping is shared with the
+// file; a writable mapping is private, so pages are only copied once they are
+// written to and the file itself is never modified.
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    storage(nx_in*ny_in),
+    data{storage.data()}
+  {}
+
+  static Array map(const char* filename, const int nx, const int ny, const bool writable) {
+    const int fd = open(filename, O_RDONLY);
+    if(fd < 0) {
+      perror(filename);
+      exit(1);
+    }
+    FieldHeader header;
+    if(pread(fd, &header, sizeof(header), 0) != sizeof(header)
+       || memcmp(header.magic, FIELD_MAGIC, sizeof(FIELD_MAGIC)) != 0
+       || header.real_size != sizeof(real) || header.nx != nx || header.ny != ny) {
+      fprintf(stderr, "%s is not a %dx%d field of %zu-byte reals\n", filename, nx, ny, sizeof(real));
+      exit(1);
+    }
+    const size_t length = sizeof(header) + size_t(nx)*ny*sizeof(real);
+    void* addr = writable
+      ? mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+      : mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(addr == MAP_FAILED) {
+      perror("mmap");
+      exit(1);
+    }
+    return Array(nx, ny, Mapping(addr, length));
+  }
+
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  int idx(int i, int j) const {return j + i*ny;}
+  const real* begin() const {return data;}
+
+  int nx;
+  int ny;
+  private:
+    Array(int nx_in, int ny_in, Mapping&& mapping_in) :
+      nx{nx_in}, ny{ny_in},
+      mapping{std::move(mapping_in)},
+      data{reinterpret_cast<real*>(static_cast<char*>(mapping.addr) + sizeof(FieldHeader))}
+    {}
+
+    vector<real> storage;
+    Mapping mapping;
+    real* data;
+};
+
+void write_field(const char* filename, const Array& field) {
+  FieldHeader header = {};
+  memcpy(header.magic, FIELD_MAGIC, sizeof(FIELD_MAGIC));
+  header.real_size = sizeof(real);
+  header.nx = field.nx;
+  header.ny = field.ny;
+  FILE* file = fopen(filename, "wb");
+  if(!file) {
+    perror(filename);
+    exit(1);
+  }
+  fwrite(&header, sizeof(header), 1, file);
+  fwrite(field.begin(), sizeof(real), size_t(field.nx)*field.ny, file);
+  fclose(file);
+}
+
+bool file_exists(const char* filename) {
+  struct stat st;
+  return stat(filename, &st) == 0;
+}
+
+// Reads one value per page so that the cost of faulting in a mapping can be
+// compared fairly with computing the field
+real touch_pages(const Array& field) {
+  const size_t stride = sysconf(_SC_PAGESIZE)/sizeof(real);
+  const size_t n = size_t(field.nx)*field.ny;
+  real sum = 0.0;
+  for(size_t k=0; k<n; k+=stride) {
+    sum += field.begin()[k];
+  }
+  return sum;
+}
+
+void run_jacobi(Array& p, const Array& b, const real dx, const real dy, const int max_iterations) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  Array p_new(p.nx,p.ny);
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+  }
+}
+
+double elapsed_ms(const timespec& start, const timespec& end) {
+  return (end.tv_sec - start.tv_sec)*1e3 + (end.tv_nsec - start.tv_nsec)*1e-6;
+}
+
+int main(int argc, char* argv[]) {
+  const int NX = argc > 1 ? atoi(argv[1]) : 128;
+  const int NY = argc > 2 ? atoi(argv[2]) : 128;
+  const int MAX_ITERATIONS = argc > 3 ? atoi(argv[3]) : 1<<16;
+  // The size is in the default names, so a file generated for another grid
+  // is never mapped
+  const std::string field_prefix = std::string(argv[0]) + "_" + std::to_string(NX) + "x" + std::to_string(NY);
+  const std::string b_file = argc > 4 ? argv[4] : field_prefix + "_b.field";
+  const std::string p_file = argc > 5 ? argv[5] : field_prefix + "_p.field";
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  timespec start, end;
+
+  // Reference: computing the fields in main, as every other version does
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  {
+    Array p(NX, NY);
+    Array b(NX, NY);
+
+    for(int i=0; i<NX; ++i) {
+      for(int j=0; j<NY; ++j) {
+        real x = i*dx;
+        real y = j*dx;
+
+        b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+        p(i,j) = 0.0;
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if(!file_exists(b_file.c_str())) write_field(b_file.c_str(), b);
+    if(!file_exists(p_file.c_str())) write_field(p_file.c_str(), p);
+  }
+  const double compute_setup_msec = elapsed_ms(start, end);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  const Array b = Array::map(b_file.c_str(), NX, NY, false);
+  Array p = Array::map(p_file.c_str(), NX, NY, true);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  const double map_setup_msec = elapsed_ms(start, end);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  volatile real sum = touch_pages(b) + touch_pages(p);
+  (void)sum;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  const double touch_msec = elapsed_ms(start, end);
+
+  clock_t solve_start = clock();
+  run_jacobi(p, b, dx, dy, MAX_ITERATIONS);
+  clock_t diff = clock() - solve_start;
+
+  int msec = diff * 1000 / CLOCKS_PER_SEC;
+
+  real av_error = 0.0;
+  for(int i=1; i<NX-1; ++i) {
+    for(int j=1; j<NY-1; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+      av_error += fabs(p(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+    }
+  }
+  av_error /= (NX*NY);
+
+  printf("%s, cpp, %d, %d, %d, %d, %e, %f, %f, %f\n", argv[0], NX, NY, MAX_ITERATIONS, msec, av_error,
+         compute_setup_msec, map_setup_msec, map_setup_msec + touch_msec);
+
+  return 0;
+}
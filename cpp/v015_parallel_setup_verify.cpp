@@ -0,0 +1,125 @@
+#include <omp.h>
+#include <memory>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <sys/resource.h>
+#include "harness.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+// The data is left uninitialised on allocation so that it is first touched by
+// the parallel setup loop, placing each page near the thread that uses it
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(new real[size_t(nx_in)*ny_in])
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  int idx(int i, int j) const {return j + i*ny;}
+
+  int nx;
+  int ny;
+  private:
+    std::unique_ptr<real[]> data;
+};
+
+void run_jacobi(Array& p, const Array& b, const real dx, const real dy, const int max_iterations) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  Array p_new(p.nx,p.ny);
+  for(int j=0; j<p.ny; ++j) {
+    p_new(0,j) = p(0,j);
+    p_new(p.nx-1,j) = p(p.nx-1,j);
+  }
+  for(int i=0; i<p.nx; ++i) {
+    p_new(i,0) = p(i,0);
+    p_new(i,p.ny-1) = p(i,p.ny-1);
+  }
+
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  const int NX = argc > 1 ? atoi(argv[1]) : 128;
+  const int NY = argc > 2 ? atoi(argv[2]) : 128;
+  const int MAX_ITERATIONS = argc > 3 ? atoi(argv[3]) : 1<<16;
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  double setup_start = omp_get_wtime();
+
+  // sin(pi x)*sin(pi y) is separable, so only NX+NY sines are needed
+  vector<real> sin_x(NX);
+  vector<real> sin_y(NY);
+  #pragma omp parallel for
+  for(int i=0; i<NX; ++i) {
+    real x = i*dx;
+    sin_x[i] = sin(M_PI*x);
+  }
+  #pragma omp parallel for
+  for(int j=0; j<NY; ++j) {
+    real y = j*dy;
+    sin_y[j] = sin(M_PI*y);
+  }
+
+  Array p(NX, NY);
+  Array b(NX, NY);
+
+  #pragma omp parallel for
+  for(int i=0; i<NX; ++i) {
+    #pragma omp simd
+    for(int j=0; j<NY; ++j) {
+      b(i,j) = sin_x[i]*sin_y[j];
+      p(i,j) = 0.0;
+    }
+  }
+
+  double setup_msec = (omp_get_wtime() - setup_start)*1000;
+
+  // Wall time, since clock() sums CPU time over every thread of the process
+  auto start = std::chrono::steady_clock::now();
+  run_jacobi(p, b, dx, dy, MAX_ITERATIONS);
+  int msec = elapsed_ns(start, std::chrono::steady_clock::now())/1e6;
+
+  double verify_start = omp_get_wtime();
+
+  // The analytic solution is evaluated on the fly rather than stored
+  real av_error = 0.0;
+  #pragma omp parallel for reduction(+:av_error)
+  for(int i=1; i<NX-1; ++i) {
+    #pragma omp simd reduction(+:av_error)
+    for(int j=1; j<NY-1; ++j) {
+      av_error += fabs(p(i,j) + sin_x[i]*sin_y[j]/(2.0*M_PI*M_PI));
+    }
+  }
+  av_error /= (NX*NY);
+
+  double verify_msec = (omp_get_wtime() - verify_start)*1000;
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  double peak_mb = usage.ru_maxrss/1024.0;
+
+  printf("%s, cpp, %d, %d, %d, %d, %e, %f, %f, %f, %d\n", argv[0], NX, NY, MAX_ITERATIONS, msec, av_error,
+         setup_msec, verify_msec, peak_mb, omp_get_max_threads());
+
+  return 0;
+}
@@ -0,0 +1,92 @@
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include "harness.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(nx_in*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  int idx(int i, int j) const {return j + i*ny;}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+void run_jacobi(Array& p, Array& p_new, const Array& b, const real dx, const real dy, const int max_iterations) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  const int NX = argc > 1 ? atoi(argv[1]) : 128;
+  const int NY = argc > 2 ? atoi(argv[2]) : 128;
+  const int MAX_ITERATIONS = argc > 3 ? atoi(argv[3]) : 1<<16;
+
+  HarnessOptions options;
+  if(argc > 4) options.warmups = atoi(argv[4]);
+  if(argc > 5) options.repeats = atoi(argv[5]);
+  if(argc > 6) options.flush_caches = atoi(argv[6]);
+
+  Array p(NX, NY);
+  Array p_new(NX, NY);
+  Array b(NX, NY);
+  Array p_soln(NX, NY);
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  for(int i=0; i<NX; ++i) {
+    for(int j=0; j<NY; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+
+      b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+      p_soln(i,j) = -sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI);
+    }
+  }
+
+  Stats stats = run_harness(options,
+    [&]{
+      p = Array(NX, NY);
+      p_new = Array(NX, NY);
+    },
+    [&]{run_jacobi(p, p_new, b, dx, dy, MAX_ITERATIONS);});
+
+  int msec = stats.min/1e6;
+
+  real av_error = 0.0;
+  for(int i=1; i<NX-1; ++i) {
+    for(int j=1; j<NY-1; ++j) {
+      av_error += fabs(p(i,j) - p_soln(i,j));
+    }
+  }
+  av_error /= (NX*NY);
+
+  printf("%s, cpp, %d, %d, %d, %d, %e, %.0f, %.0f, %.0f, %.0f, %d, %d, %d\n", argv[0], NX, NY, MAX_ITERATIONS, msec, av_error,
+         stats.min, stats.median, stats.mean, stats.std, options.warmups, options.repeats, options.flush_caches);
+
+  return 0;
+}
@@ -0,0 +1,163 @@
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "harness.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(size_t(nx_in)*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  size_t idx(int i, int j) const {return j + size_t(i)*ny;}
+  real* begin() {return data.data();}
+  const real* begin() const {return data.data();}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// The kernel from V008. The caller owns p_new, so that allocating and first
+// touching it isn't timed.
+void run_jacobi_array(Array& p, Array& p_new, const Array& b, const real dx, const real dy, const int max_iterations) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+  }
+}
+
+// The same loop on raw pointers marked as not aliasing
+void run_jacobi_raw(Array& p_array, Array& p_new_array, const Array& b_array, const real dx, const real dy,
+                    const int max_iterations) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  const int nx = p_array.nx;
+  const int ny = p_array.ny;
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    const real* __restrict p = p_array.begin();
+    const real* __restrict b = b_array.begin();
+    real* __restrict p_new = p_new_array.begin();
+    for(int i=1; i<nx-1; ++i) {
+      for(int j=1; j<ny-1; ++j) {
+        const size_t k = j + size_t(i)*ny;
+        p_new[k] = D_x*(p[k+ny] + p[k-ny]) + D_y*(p[k+1] + p[k-1]) + B*b[k];
+      }
+    }
+    std::swap(p_array, p_new_array);
+  }
+}
+
+typedef void (*Kernel)(Array&, Array&, const Array&, const real, const real, const int);
+
+// Powers of two and their neighbours from min_size to max_size, so that both
+// the cache capacity transitions and pathological strides show up
+vector<int> sweep_sizes(const int min_size, const int max_size) {
+  vector<int> sizes;
+  for(long n=4; n<=2*max_size; n*=2) {
+    for(int offset=-2; offset<=2; ++offset) {
+      if(n+offset >= std::max(min_size, 3) && n+offset <= max_size) sizes.push_back(n+offset);
+    }
+  }
+  std::sort(sizes.begin(), sizes.end());
+  sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+  return sizes;
+}
+
+int main(int argc, char* argv[]) {
+  const char* kernel_name = argc > 1 ? argv[1] : "array";
+  const int MIN_SIZE = argc > 2 ? atoi(argv[2]) : 16;
+  // 4096 is a 384 MB footprint in double, well past any last-level cache
+  const int MAX_SIZE = argc > 3 ? atoi(argv[3]) : 4096;
+  // Total point updates per measurement, so each takes roughly the same time
+  const double TARGET_UPDATES = argc > 4 ? atof(argv[4]) : double(1<<28);
+  // Sweep nx only at a fixed ny, e.g. 8, instead of square grids
+  const int FIXED_NY = argc > 5 ? atoi(argv[5]) : 0;
+
+  Kernel kernel;
+  if(strcmp(kernel_name, "array") == 0) {
+    kernel = run_jacobi_array;
+  } else if(strcmp(kernel_name, "raw") == 0) {
+    kernel = run_jacobi_raw;
+  } else {
+    fprintf(stderr, "Unknown kernel %s, expected array or raw\n", kernel_name);
+    return 1;
+  }
+
+  HarnessOptions options;
+  options.warmups = 1;
+  options.repeats = 3;
+
+  for(const int size : sweep_sizes(MIN_SIZE, MAX_SIZE)) {
+    const int NX = size;
+    const int NY = FIXED_NY > 0 ? FIXED_NY : size;
+    const double points = double(NX-2)*(NY-2);
+    const int MAX_ITERATIONS = std::max(1.0, std::round(TARGET_UPDATES/points));
+
+    Array p(NX, NY);
+    Array p_new(NX, NY);
+    Array b(NX, NY);
+
+    real dx = 1.0/(NX-1);
+    real dy = 1.0/(NY-1);
+
+    for(int i=0; i<NX; ++i) {
+      for(int j=0; j<NY; ++j) {
+        real x = i*dx;
+        real y = j*dy;
+
+        b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+      }
+    }
+
+    Stats stats = run_harness(options,
+      [&]{
+        std::fill(p.begin(), p.begin() + size_t(NX)*NY, 0.0);
+        std::fill(p_new.begin(), p_new.begin() + size_t(NX)*NY, 0.0);
+      },
+      [&]{kernel(p, p_new, b, dx, dy, MAX_ITERATIONS);});
+
+    int msec = stats.min/1e6;
+
+    real av_error = 0.0;
+    for(int i=1; i<NX-1; ++i) {
+      for(int j=1; j<NY-1; ++j) {
+        real x = i*dx;
+        real y = j*dy;
+        av_error += fabs(p(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+      }
+    }
+    av_error /= (double(NX)*NY);
+
+    const double ns_per_update = stats.min/(points*MAX_ITERATIONS);
+    const double footprint_kb = 3.0*NX*NY*sizeof(real)/1024;
+
+    printf("%s, cpp, %d, %d, %d, %d, %e, %s, %f, %f\n", argv[0], NX, NY, MAX_ITERATIONS, msec, av_error,
+           kernel_name, footprint_kb, ns_per_update);
+    fflush(stdout);
+  }
+
+  return 0;
+}
@@ -0,0 +1,559 @@
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <fnmatch.h>
+#include "harness.hpp"
+#include "kernel_registry.hpp"
+
+using std::vector;
+
+// The kernels below are ported from the separate C and C++ variants and keep
+// each one's distinguishing feature. The main differences to the originals:
+// the iteration count is always a run time argument, temporary arrays are
+// zeroed so that their unused boundaries are not garbage, and pointer-swapping
+// kernels copy the result back to p after an odd number of iterations.
+
+// Size of the variants that fix it at compile time
+const int FIXED_NX = 128;
+const int FIXED_NY = 128;
+
+// Copies the latest iterate back if it is not already in the caller's array
+template<typename real>
+void copy_result(real* p, const real* latest, const int nx, const int ny) {
+  if(latest != p) memcpy(p, latest, size_t(nx)*ny*sizeof(real));
+}
+
+// c/v001: index macro on compile time sizes
+#define IDX(i,j) (j) + (i)*FIXED_NY
+template<typename real>
+void c_v001_original(real* p_in, const real* b, const Grid<real>& grid) {
+  const real dx = 1.0/(FIXED_NX-1);
+  const real dy = 1.0/(FIXED_NY-1);
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  real* p = p_in;
+  real* p_new = (real*)calloc(FIXED_NX*FIXED_NY, sizeof(real));
+  for(int iter = 0; iter<grid.max_iterations; ++iter) {
+    for(int i=1; i<FIXED_NX-1; ++i) {
+      for(int j=1; j<FIXED_NY-1; ++j) {
+        p_new[IDX(i,j)] = D_x*(p[IDX(i+1,j)] + p[IDX(i-1,j)]) + D_y*(p[IDX(i,j+1)] + p[IDX(i,j-1)]) + B*b[IDX(i,j)];
+      }
+    }
+    real* temp = p_new;
+    p_new = p;
+    p = temp;
+  }
+  copy_result(p_in, p, FIXED_NX, FIXED_NY);
+  free(p == p_in ? p_new : p);
+}
+#undef IDX
+REGISTER_KERNEL("c/v001_original", "c", FIXED_NX, FIXED_NY, c_v001_original)
+
+inline int fixed_idx(const int i, const int j) {return j + i*FIXED_NY;}
+
+// c/v005: coefficients recomputed inside the loop
+template<typename real>
+void c_v005_no_precompute_constants(real* p_in, const real* b, const Grid<real>& grid) {
+  const real dx = 1.0/(FIXED_NX-1);
+  const real dy = 1.0/(FIXED_NY-1);
+
+  real* p = p_in;
+  real* p_new = (real*)calloc(FIXED_NX*FIXED_NY, sizeof(real));
+  for(int iter = 0; iter<grid.max_iterations; ++iter) {
+    for(int i=1; i<FIXED_NX-1; ++i) {
+      for(int j=1; j<FIXED_NY-1; ++j) {
+        p_new[fixed_idx(i,j)] = dy*dy/(2.0*(dx*dx + dy*dy))*(p[fixed_idx(i+1,j)] + p[fixed_idx(i-1,j)]) + dx*dx/(2.0*(dx*dx + dy*dy))*(p[fixed_idx(i,j+1)] + p[fixed_idx(i,j-1)]) + -(dx*dx*dy*dy)/(2.0*(dx*dx + dy*dy))*b[fixed_idx(i,j)];
+      }
+    }
+    real* temp = p_new;
+    p_new = p;
+    p = temp;
+  }
+  copy_result(p_in, p, FIXED_NX, FIXED_NY);
+  free(p == p_in ? p_new : p);
+}
+REGISTER_KERNEL("c/v005_no_precompute_constants", "c", FIXED_NX, FIXED_NY, c_v005_no_precompute_constants)
+
+// c/v010: parameters passed through a struct pointer
+template<typename real>
+struct JacobiParams {
+  real D_x;
+  real D_y;
+  real B;
+  int nx;
+  int ny;
+  int max_iterations;
+};
+
+template<typename real>
+void c_v010_run_jacobi(real *p, const real* b, const JacobiParams<real>* jp) {
+  real* p_in = p;
+  real* p_new = (real*)calloc(jp->nx*jp->ny, sizeof(real));
+  for(int iter = 0; iter<jp->max_iterations; ++iter) {
+    for(int i=1; i<jp->nx-1; ++i) {
+      for(int j=1; j<jp->ny-1; ++j) {
+        p_new[j + i*jp->ny] = jp->D_x*(p[j + (i+1)*jp->ny] + p[j + (i-1)*jp->ny]) + jp->D_y*(p[(j+1) + i*jp->ny] + p[(j-1) + i*jp->ny]) + jp->B*b[j + i*jp->ny];
+      }
+    }
+    real* temp = p_new;
+    p_new = p;
+    p = temp;
+  }
+  copy_result(p_in, p, jp->nx, jp->ny);
+  free(p == p_in ? p_new : p);
+}
+
+template<typename real>
+void c_v010_params_structure(real* p, const real* b, const Grid<real>& grid) {
+  real D = 2.0*(grid.dx*grid.dx + grid.dy*grid.dy);
+  JacobiParams<real> jp;
+  jp.D_x = grid.dy*grid.dy/D;
+  jp.D_y = grid.dx*grid.dx/D;
+  jp.B = -(grid.dx*grid.dx*grid.dy*grid.dy)/D;
+  jp.nx = grid.nx;
+  jp.ny = grid.ny;
+  jp.max_iterations = grid.max_iterations;
+  c_v010_run_jacobi(p, b, &jp);
+}
+REGISTER_KERNEL("c/v010_params_structure", "c", 0, 0, c_v010_params_structure)
+
+// c/v014: everything known only at run time
+template<typename real>
+void c_v014_external_parameters(real* p_in, const real* b, const Grid<real>& grid) {
+  const int nx = grid.nx;
+  const int ny = grid.ny;
+  const real dx = grid.dx;
+  const real dy = grid.dy;
+  const real D = 2.0*(dx*dx + dy*dy);
+  const real D_x = dy*dy/D;
+  const real D_y = dx*dx/D;
+  const real B = -(dx*dx*dy*dy)/D;
+
+  real* p = p_in;
+  real* p_new = (real*)calloc(nx*ny, sizeof(real));
+  for(int iter = 0; iter<grid.max_iterations; ++iter) {
+    for(int i=1; i<nx-1; ++i) {
+      for(int j=1; j<ny-1; ++j) {
+        p_new[j + i*ny] = D_x*(p[j + (i+1)*ny] + p[j + (i-1)*ny]) + D_y*(p[(j+1) + i*ny] + p[(j-1) + i*ny]) + B*b[j + i*ny];
+      }
+    }
+    real* temp = p_new;
+    p_new = p;
+    p = temp;
+  }
+  copy_result(p_in, p, nx, ny);
+  free(p == p_in ? p_new : p);
+}
+REGISTER_KERNEL("c/v014_external_parameters", "c", 0, 0, c_v014_external_parameters)
+
+// c/v016: sizes and coefficients all compile time constants
+template<typename real>
+void c_v016_literal_passed_global_params(real* p_in, const real* b, const Grid<real>& grid) {
+  const real DX = 1.0/(FIXED_NX-1);
+  const real DY = 1.0/(FIXED_NY-1);
+  const real D = 2.0*(DX*DX + DY*DY);
+  const real D_x = DY*DY/D;
+  const real D_y = DX*DX/D;
+  const real B = -(DX*DX*DY*DY)/D;
+
+  real* p = p_in;
+  real* p_new = (real*)calloc(FIXED_NX*FIXED_NY, sizeof(real));
+  for(int iter = 0; iter<grid.max_iterations; ++iter) {
+    for(int i=1; i<FIXED_NX-1; ++i) {
+      for(int j=1; j<FIXED_NY-1; ++j) {
+        p_new[fixed_idx(i,j)] = D_x*(p[fixed_idx(i+1,j)] + p[fixed_idx(i-1,j)]) + D_y*(p[fixed_idx(i,j+1)] + p[fixed_idx(i,j-1)]) + B*b[fixed_idx(i,j)];
+      }
+    }
+    real* temp = p_new;
+    p_new = p;
+    p = temp;
+  }
+  copy_result(p_in, p, FIXED_NX, FIXED_NY);
+  free(p == p_in ? p_new : p);
+}
+REGISTER_KERNEL("c/v016_literal_passed_global_params", "c", FIXED_NX, FIXED_NY, c_v016_literal_passed_global_params)
+
+// c/v017: static 2D arrays, two sweeps per iteration instead of a swap
+template<typename real>
+void c_v017_static_arrays(real* p_in, const real* b_in, const Grid<real>& grid) {
+  const real DX = 1.0/(FIXED_NX-1);
+  const real DY = 1.0/(FIXED_NY-1);
+  const real D = 2.0*(DX*DX + DY*DY);
+  const real D_x = DY*DY/D;
+  const real D_y = DX*DX/D;
+  const real B = -(DX*DX*DY*DY)/D;
+
+  real (*p)[FIXED_NY] = (real (*)[FIXED_NY])p_in;
+  const real (*b)[FIXED_NY] = (const real (*)[FIXED_NY])b_in;
+  real p_new[FIXED_NX][FIXED_NY];
+  memcpy(p_new, p, sizeof(p_new));
+  for(int iter = 0; iter<grid.max_iterations/2; ++iter) {
+    for(int i=1; i<FIXED_NX-1; ++i) {
+      for(int j=1; j<FIXED_NY-1; ++j) {
+        p_new[i][j] = D_x*(p[i+1][j] + p[i-1][j]) + D_y*(p[i][j+1] + p[i][j-1]) + B*b[i][j];
+      }
+    }
+    for(int i=1; i<FIXED_NX-1; ++i) {
+      for(int j=1; j<FIXED_NY-1; ++j) {
+        p[i][j] = D_x*(p_new[i+1][j] + p_new[i-1][j]) + D_y*(p_new[i][j+1] + p_new[i][j-1]) + B*b[i][j];
+      }
+    }
+  }
+  // An odd count needs one more sweep, copied back since the result belongs in p
+  if(grid.max_iterations % 2) {
+    for(int i=1; i<FIXED_NX-1; ++i) {
+      for(int j=1; j<FIXED_NY-1; ++j) {
+        p_new[i][j] = D_x*(p[i+1][j] + p[i-1][j]) + D_y*(p[i][j+1] + p[i][j-1]) + B*b[i][j];
+      }
+    }
+    memcpy(p, p_new, sizeof(p_new));
+  }
+}
+REGISTER_KERNEL("c/v017_static_arrays", "c", FIXED_NX, FIXED_NY, c_v017_static_arrays)
+
+// c/v018: static 2D arrays, copying back instead of swapping
+template<typename real>
+void c_v018_static_arrays_memcpy(real* p_in, const real* b_in, const Grid<real>& grid) {
+  const real DX = 1.0/(FIXED_NX-1);
+  const real DY = 1.0/(FIXED_NY-1);
+  const real D = 2.0*(DX*DX + DY*DY);
+  const real D_x = DY*DY/D;
+  const real D_y = DX*DX/D;
+  const real B = -(DX*DX*DY*DY)/D;
+
+  real (*p)[FIXED_NY] = (real (*)[FIXED_NY])p_in;
+  const real (*b)[FIXED_NY] = (const real (*)[FIXED_NY])b_in;
+  real p_new[FIXED_NX][FIXED_NY];
+  memcpy(p_new, p, sizeof(p_new));
+  for(int iter = 0; iter<grid.max_iterations; ++iter) {
+    for(int i=1; i<FIXED_NX-1; ++i) {
+      for(int j=1; j<FIXED_NY-1; ++j) {
+        p_new[i][j] = D_x*(p[i+1][j] + p[i-1][j]) + D_y*(p[i][j+1] + p[i][j-1]) + B*b[i][j];
+      }
+    }
+    memcpy(p, p_new, FIXED_NX*FIXED_NY*sizeof(real));
+  }
+}
+REGISTER_KERNEL("c/v018_static_arrays_memcpy", "c", FIXED_NX, FIXED_NY, c_v018_static_arrays_memcpy)
+
+// c/v019: static 2D arrays updated in place (Gauss-Seidel)
+template<typename real>
+void c_v019_static_arrays_gauss_seidel(real* p_in, const real* b_in, const Grid<real>& grid) {
+  const real DX = 1.0/(FIXED_NX-1);
+  const real DY = 1.0/(FIXED_NY-1);
+  const real D = 2.0*(DX*DX + DY*DY);
+  const real D_x = DY*DY/D;
+  const real D_y = DX*DX/D;
+  const real B = -(DX*DX*DY*DY)/D;
+
+  real (*p)[FIXED_NY] = (real (*)[FIXED_NY])p_in;
+  const real (*b)[FIXED_NY] = (const real (*)[FIXED_NY])b_in;
+  for(int iter = 0; iter<grid.max_iterations; ++iter) {
+    for(int i=1; i<FIXED_NX-1; ++i) {
+      for(int j=1; j<FIXED_NY-1; ++j) {
+        p[i][j] = D_x*(p[i+1][j] + p[i-1][j]) + D_y*(p[i][j+1] + p[i][j-1]) + B*b[i][j];
+      }
+    }
+  }
+}
+REGISTER_KERNEL("c/v019_static_arrays_gauss_seidel", "c", FIXED_NX, FIXED_NY, c_v019_static_arrays_gauss_seidel)
+
+// c/v020: interior indexed from 0 with a ghost layer around it
+const int NG = 1;
+inline int ghost_idx(const int i, const int j) {return (j+NG) + (i+NG)*FIXED_NY;}
+
+template<typename real>
+void c_v020_ghost_points(real* p_in, const real* b, const Grid<real>& grid) {
+  const int NX = FIXED_NX - 2*NG;
+  const int NY = FIXED_NY - 2*NG;
+  const real DX = 1.0/(FIXED_NX-1);
+  const real DY = 1.0/(FIXED_NY-1);
+  const real D = 2.0*(DX*DX + DY*DY);
+  const real D_x = DY*DY/D;
+  const real D_y = DX*DX/D;
+  const real B = -(DX*DX*DY*DY)/D;
+
+  real* p = p_in;
+  real* p_new = (real*)calloc(FIXED_NX*FIXED_NY, sizeof(real));
+  for(int iter = 0; iter<grid.max_iterations; ++iter) {
+    for(int i=0; i<NX; ++i) {
+      for(int j=0; j<NY; ++j) {
+        p_new[ghost_idx(i,j)] = D_x*(p[ghost_idx(i+1,j)] + p[ghost_idx(i-1,j)]) + D_y*(p[ghost_idx(i,j+1)] + p[ghost_idx(i,j-1)]) + B*b[ghost_idx(i,j)];
+      }
+    }
+    real* temp = p_new;
+    p_new = p;
+    p = temp;
+  }
+  copy_result(p_in, p, FIXED_NX, FIXED_NY);
+  free(p == p_in ? p_new : p);
+}
+REGISTER_KERNEL("c/v020_ghost_points", "c", FIXED_NX, FIXED_NY, c_v020_ghost_points)
+
+// cpp/v002: new[] and std::swap on compile time sizes
+template<typename real>
+void cpp_v002_std_swap(real* p_in, const real* b, const Grid<real>& grid) {
+  const real dx = 1.0/(FIXED_NX-1);
+  const real dy = 1.0/(FIXED_NY-1);
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  real* p = p_in;
+  real* p_new = new real[FIXED_NX*FIXED_NY]();
+  for(int iter = 0; iter<grid.max_iterations; ++iter) {
+    for(int i=1; i<FIXED_NX-1; ++i) {
+      for(int j=1; j<FIXED_NY-1; ++j) {
+        p_new[fixed_idx(i,j)] = D_x*(p[fixed_idx(i+1,j)] + p[fixed_idx(i-1,j)]) + D_y*(p[fixed_idx(i,j+1)] + p[fixed_idx(i,j-1)]) + B*b[fixed_idx(i,j)];
+      }
+    }
+    std::swap(p, p_new);
+  }
+  copy_result(p_in, p, FIXED_NX, FIXED_NY);
+  delete[] (p == p_in ? p_new : p);
+}
+REGISTER_KERNEL("cpp/v002_std_swap", "cpp", FIXED_NX, FIXED_NY, cpp_v002_std_swap)
+
+// The container variants own their storage, so the input is copied in and
+// the result out. That is one sweep's worth of traffic per call.
+
+// cpp/v004: std::vector on compile time sizes
+template<typename real>
+void cpp_v004_vector(real* p_in, const real* b_in, const Grid<real>& grid) {
+  const real dx = 1.0/(FIXED_NX-1);
+  const real dy = 1.0/(FIXED_NY-1);
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  vector<real> p(p_in, p_in + FIXED_NX*FIXED_NY);
+  const vector<real> b(b_in, b_in + FIXED_NX*FIXED_NY);
+  vector<real> p_new(FIXED_NX*FIXED_NY);
+  for(int iter = 0; iter<grid.max_iterations; ++iter) {
+    for(int i=1; i<FIXED_NX-1; ++i) {
+      for(int j=1; j<FIXED_NY-1; ++j) {
+        p_new[fixed_idx(i,j)] = D_x*(p[fixed_idx(i+1,j)] + p[fixed_idx(i-1,j)]) + D_y*(p[fixed_idx(i,j+1)] + p[fixed_idx(i,j-1)]) + B*b[fixed_idx(i,j)];
+      }
+    }
+    std::swap(p, p_new);
+  }
+  std::copy(p.begin(), p.end(), p_in);
+}
+REGISTER_KERNEL("cpp/v004_vector", "cpp", FIXED_NX, FIXED_NY, cpp_v004_vector)
+
+// The Array class from cpp/v008, which carries its own size
+template<typename real>
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(nx_in*ny_in)
+  {}
+  Array(int nx_in, int ny_in, const real* values) :
+    nx{nx_in}, ny{ny_in},
+    data(values, values + nx_in*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  int idx(int i, int j) const {return j + i*ny;}
+  const real* begin() const {return data.data();}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// cpp/v006: Array class, loop bounds from compile time sizes
+template<typename real>
+void cpp_v006_array_class(real* p_in, const real* b_in, const Grid<real>& grid) {
+  const real dx = 1.0/(FIXED_NX-1);
+  const real dy = 1.0/(FIXED_NY-1);
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  Array<real> p(FIXED_NX, FIXED_NY, p_in);
+  const Array<real> b(FIXED_NX, FIXED_NY, b_in);
+  Array<real> p_new(FIXED_NX, FIXED_NY);
+  for(int iter = 0; iter<grid.max_iterations; ++iter) {
+    for(int i=1; i<FIXED_NX-1; ++i) {
+      for(int j=1; j<FIXED_NY-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+  }
+  std::copy(p.begin(), p.begin() + FIXED_NX*FIXED_NY, p_in);
+}
+REGISTER_KERNEL("cpp/v006_array_class", "cpp", FIXED_NX, FIXED_NY, cpp_v006_array_class)
+
+// cpp/v008: Array class, loop bounds from the array
+template<typename real>
+void cpp_v008_array_class_no_globals(real* p_in, const real* b_in, const Grid<real>& grid) {
+  const real dx = grid.dx;
+  const real dy = grid.dy;
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  Array<real> p(grid.nx, grid.ny, p_in);
+  const Array<real> b(grid.nx, grid.ny, b_in);
+  Array<real> p_new(p.nx, p.ny);
+  for(int iter = 0; iter<grid.max_iterations; ++iter) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+  }
+  std::copy(p.begin(), p.begin() + grid.nx*grid.ny, p_in);
+}
+REGISTER_KERNEL("cpp/v008_array_class_no_globals", "cpp", 0, 0, cpp_v008_array_class_no_globals)
+
+// cpp/v019: raw pointers marked as not aliasing
+template<typename real>
+void cpp_v019_raw(real* p_in, const real* b_in, const Grid<real>& grid) {
+  const int nx = grid.nx;
+  const int ny = grid.ny;
+  const real dx = grid.dx;
+  const real dy = grid.dy;
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  vector<real> p_new_array(size_t(nx)*ny);
+  real* p_array = p_in;
+  real* p_new_ptr = p_new_array.data();
+  for(int iter = 0; iter<grid.max_iterations; ++iter) {
+    const real* __restrict p = p_array;
+    const real* __restrict b = b_in;
+    real* __restrict p_new = p_new_ptr;
+    for(int i=1; i<nx-1; ++i) {
+      for(int j=1; j<ny-1; ++j) {
+        const size_t k = j + size_t(i)*ny;
+        p_new[k] = D_x*(p[k+ny] + p[k-ny]) + D_y*(p[k+1] + p[k-1]) + B*b[k];
+      }
+    }
+    std::swap(p_array, p_new_ptr);
+  }
+  copy_result(p_in, p_array, nx, ny);
+}
+REGISTER_KERNEL("cpp/v019_raw", "cpp", 0, 0, cpp_v019_raw)
+
+// Inputs shared by every kernel of one precision
+template<typename real>
+struct Problem {
+  Problem(const int nx, const int ny, const int max_iterations) :
+    grid{nx, ny, real(1.0/(nx-1)), real(1.0/(ny-1)), max_iterations},
+    p(size_t(nx)*ny),
+    b(size_t(nx)*ny)
+  {
+    for(int i=0; i<nx; ++i) {
+      for(int j=0; j<ny; ++j) {
+        real x = i*grid.dx;
+        real y = j*grid.dy;
+        b[j + size_t(i)*ny] = sin(M_PI*x)*sin(M_PI*y);
+      }
+    }
+  }
+
+  real av_error() const {
+    real av_error = 0.0;
+    for(int i=1; i<grid.nx-1; ++i) {
+      for(int j=1; j<grid.ny-1; ++j) {
+        real x = i*grid.dx;
+        real y = j*grid.dy;
+        av_error += fabs(p[j + size_t(i)*grid.ny] + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+      }
+    }
+    return av_error/(double(grid.nx)*grid.ny);
+  }
+
+  Grid<real> grid;
+  vector<real> p;
+  vector<real> b;
+};
+
+bool matches(const char* name, const char* precision, const vector<const char*>& patterns) {
+  char full_name[256];
+  snprintf(full_name, sizeof(full_name), "%s/%s", name, precision);
+  for(const char* pattern : patterns) {
+    if(fnmatch(pattern, full_name, 0) == 0) return true;
+  }
+  return false;
+}
+
+template<typename real>
+void list_kernels() {
+  for(const KernelInfo<real>& kernel : kernel_registry<real>()) {
+    if(kernel.compile_time_size()) {
+      printf("%s/%s (%dx%d only)\n", kernel.name, precision_name<real>(), kernel.fixed_nx, kernel.fixed_ny);
+    } else {
+      printf("%s/%s\n", kernel.name, precision_name<real>());
+    }
+  }
+}
+
+template<typename real>
+void run_kernels(const int nx, const int ny, const int max_iterations, const HarnessOptions& options,
+                 const vector<const char*>& patterns) {
+  Problem<real> problem(nx, ny, max_iterations);
+  for(const KernelInfo<real>& kernel : kernel_registry<real>()) {
+    if(!matches(kernel.name, precision_name<real>(), patterns)) continue;
+    if(!kernel.supports(nx, ny)) {
+      fprintf(stderr, "Skipping %s/%s, which only runs at %dx%d\n", kernel.name, precision_name<real>(),
+              kernel.fixed_nx, kernel.fixed_ny);
+      continue;
+    }
+
+    Stats stats = run_harness(options,
+      [&]{std::fill(problem.p.begin(), problem.p.end(), 0.0);},
+      [&]{kernel.run(problem.p.data(), problem.b.data(), problem.grid);});
+
+    int msec = stats.min/1e6;
+
+    printf("%s, %s, %d, %d, %d, %d, %e, %s, %d, %.0f, %.0f, %.0f\n", kernel.name, kernel.language, nx, ny,
+           max_iterations, msec, problem.av_error(), precision_name<real>(), kernel.compile_time_size(),
+           stats.median, stats.mean, stats.std);
+    fflush(stdout);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if(argc > 1 && strcmp(argv[1], "list") == 0) {
+    list_kernels<float>();
+    list_kernels<double>();
+    return 0;
+  }
+
+  const int NX = argc > 1 ? atoi(argv[1]) : 128;
+  const int NY = argc > 2 ? atoi(argv[2]) : 128;
+  const int MAX_ITERATIONS = argc > 3 ? atoi(argv[3]) : 1<<16;
+
+  HarnessOptions options;
+  options.warmups = argc > 4 ? atoi(argv[4]) : 1;
+  options.repeats = argc > 5 ? atoi(argv[5]) : 3;
+
+  // Shell-style patterns on name/precision, e.g. 'c/*' or '*/float'
+  vector<const char*> patterns;
+  for(int k=6; k<argc; ++k) patterns.push_back(argv[k]);
+  if(patterns.empty()) patterns.push_back("*");
+
+  run_kernels<float>(NX, NY, MAX_ITERATIONS, options, patterns);
+  run_kernels<double>(NX, NY, MAX_ITERATIONS, options, patterns);
+
+  return 0;
+}
@@ -0,0 +1,206 @@
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include "harness.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+const int NX = 128;
+const int NY = 128;
+const int MAX_ITERATIONS = 1<<16;
+
+// Expression templates: arithmetic on arrays builds a tree of lightweight
+// objects instead of computing anything, and only assigning the tree to an
+// Array evaluates it, point by point in a single loop with no temporaries.
+// Every node is an Expr, which is evaluated at (i,j) through operator().
+
+template<typename E>
+struct Expr {
+  const E& self() const {return static_cast<const E&>(*this);}
+};
+
+class Array : public Expr<Array> {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(nx_in*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  int idx(int i, int j) const {return j + i*ny;}
+
+  // Evaluates the expression over the interior, leaving the boundary as it
+  // is. The expression must not read this array, as points would be
+  // overwritten before their neighbours have used them.
+  template<typename E>
+  Array& operator=(const Expr<E>& expr) {
+    const E& e = expr.self();
+    for(int i=1; i<nx-1; ++i) {
+      for(int j=1; j<ny-1; ++j) {
+        data[idx(i,j)] = e(i,j);
+      }
+    }
+    return *this;
+  }
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// Arrays are held in the tree by reference, everything else by value, as
+// the intermediate nodes are temporaries that die at the end of the statement
+template<typename E> struct ExprStorage {typedef const E type;};
+template<> struct ExprStorage<Array> {typedef const Array& type;};
+
+class Shift : public Expr<Shift> {
+  public:
+  Shift(const Array& a_in, const int di_in, const int dj_in) :
+    a{a_in}, di{di_in}, dj{dj_in}
+  {}
+  real operator()(const int i, const int j) const {return a(i+di,j+dj);}
+
+  private:
+    const Array& a;
+    const int di;
+    const int dj;
+};
+
+// The array offset by (di,dj), i.e. shift(p,1,0)(i,j) is p(i+1,j)
+inline Shift shift(const Array& a, const int di, const int dj) {return Shift(a, di, dj);}
+
+template<typename L, typename R>
+class Sum : public Expr<Sum<L,R>> {
+  public:
+  Sum(const L& l_in, const R& r_in) : l{l_in}, r{r_in} {}
+  real operator()(const int i, const int j) const {return l(i,j) + r(i,j);}
+
+  private:
+    typename ExprStorage<L>::type l;
+    typename ExprStorage<R>::type r;
+};
+
+template<typename E>
+class Scaled : public Expr<Scaled<E>> {
+  public:
+  Scaled(const real s_in, const E& e_in) : s{s_in}, e{e_in} {}
+  real operator()(const int i, const int j) const {return s*e(i,j);}
+
+  private:
+    const real s;
+    typename ExprStorage<E>::type e;
+};
+
+template<typename L, typename R>
+Sum<L,R> operator+(const Expr<L>& l, const Expr<R>& r) {return Sum<L,R>(l.self(), r.self());}
+
+template<typename E>
+Scaled<E> operator*(const real s, const Expr<E>& e) {return Scaled<E>(s, e.self());}
+
+void run_jacobi_expression(Array& p, const Array& b, const real dx, const real dy) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  Array p_new(p.nx,p.ny);
+  for(int iter = 0; iter<MAX_ITERATIONS; ++iter) {
+    p_new = D_x*(shift(p,1,0) + shift(p,-1,0)) + D_y*(shift(p,0,1) + shift(p,0,-1)) + B*b;
+    std::swap(p, p_new);
+  }
+}
+
+// The hand-written loop of V006, with compile time loop bounds
+void run_jacobi_v006(Array& p, const Array& b, const real dx, const real dy) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  Array p_new(p.nx,p.ny);
+  for(int iter = 0; iter<MAX_ITERATIONS; ++iter) {
+    for(int i=1; i<NX-1; ++i) {
+      for(int j=1; j<NY-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+  }
+}
+
+// The hand-written loop of V008, with bounds from the array like the
+// expression's
+void run_jacobi_v008(Array& p, const Array& b, const real dx, const real dy) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  Array p_new(p.nx,p.ny);
+  for(int iter = 0; iter<MAX_ITERATIONS; ++iter) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+  }
+}
+
+typedef void (*Kernel)(Array&, const Array&, const real, const real);
+
+int main(int argc, char* argv[]) {
+  HarnessOptions options;
+  options.warmups = 1;
+  options.repeats = argc > 1 ? atoi(argv[1]) : 3;
+
+  Array b(NX, NY);
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  for(int i=0; i<NX; ++i) {
+    for(int j=0; j<NY; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+
+      b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+    }
+  }
+
+  // The expression and the two hand-written loops, timed in turn in the same
+  // process
+  const Kernel kernels[3] = {run_jacobi_expression, run_jacobi_v006, run_jacobi_v008};
+  vector<Array> results(3, Array(NX, NY));
+  double msec[3];
+  for(int k=0; k<3; ++k) {
+    Array& p = results[k];
+    Stats stats = run_harness(options,
+      [&]{for(int i=0; i<NX; ++i) for(int j=0; j<NY; ++j) p(i,j) = 0.0;},
+      [&]{kernels[k](p, b, dx, dy);});
+    msec[k] = stats.min/1e6;
+  }
+
+  const Array& p = results[0];
+  real av_error = 0.0;
+  real max_diff = 0.0;
+  for(int i=1; i<NX-1; ++i) {
+    for(int j=1; j<NY-1; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+      av_error += fabs(p(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+      max_diff = std::max(max_diff, real(fabs(p(i,j) - results[1](i,j))));
+    }
+  }
+  av_error /= (NX*NY);
+
+  printf("%s, cpp, %d, %d, %d, %d, %e, %f, %f, %e\n", argv[0], NX, NY, MAX_ITERATIONS, int(msec[0]), av_error,
+         msec[1], msec[2], max_diff);
+
+  return 0;
+}
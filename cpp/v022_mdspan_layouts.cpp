@@ -0,0 +1,138 @@
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include <utility>
+#include "harness.hpp"
+#include "mdspan.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+// Owns the storage, sized by the layout's mapping including any padding, and
+// hands out mdspan views of it
+template<typename Layout>
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(typename Layout::mapping(extents{nx_in, ny_in}).required_span_size())
+  {}
+  mdspan<real, Layout> view() {return mdspan<real, Layout>(data.data(), extents{nx, ny});}
+  mdspan<const real, Layout> view() const {return mdspan<const real, Layout>(data.data(), extents{nx, ny});}
+  size_t span_size() const {return data.size();}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// The kernel, written once for every layout
+template<typename Layout>
+void sweep(const mdspan<real, Layout>& p_new, const mdspan<const real, Layout>& p, const mdspan<const real, Layout>& b,
+           const real D_x, const real D_y, const real B) {
+  const int nx = p.extent(0);
+  const int ny = p.extent(1);
+  for(int i=1; i<nx-1; ++i) {
+    for(int j=1; j<ny-1; ++j) {
+      p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+    }
+  }
+}
+
+// p_new is the caller's, so allocating and first touching it isn't timed
+template<typename Layout>
+void run_jacobi(Array<Layout>& p, Array<Layout>& p_new, const Array<Layout>& b, const real dx, const real dy,
+                const int max_iterations) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    sweep<Layout>(p_new.view(), std::as_const(p).view(), b.view(), D_x, D_y, B);
+    std::swap(p, p_new);
+  }
+}
+
+template<typename Layout>
+void benchmark_layout(const char* exe_name, const int NX, const int NY, const double target_updates) {
+  const double points = double(NX-2)*(NY-2);
+  const int MAX_ITERATIONS = std::max(1.0, std::round(target_updates/points));
+
+  Array<Layout> p(NX, NY);
+  Array<Layout> p_new(NX, NY);
+  Array<Layout> b(NX, NY);
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  auto b_view = b.view();
+  for(int i=0; i<NX; ++i) {
+    for(int j=0; j<NY; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+
+      b_view(i,j) = sin(M_PI*x)*sin(M_PI*y);
+    }
+  }
+
+  HarnessOptions options;
+  options.warmups = 1;
+  options.repeats = 3;
+
+  Stats stats = run_harness(options,
+    [&]{
+      auto p_view = p.view();
+      auto p_new_view = p_new.view();
+      for(int i=0; i<NX; ++i) {
+        for(int j=0; j<NY; ++j) {
+          p_view(i,j) = 0.0;
+          p_new_view(i,j) = 0.0;
+        }
+      }
+    },
+    [&]{run_jacobi(p, p_new, b, dx, dy, MAX_ITERATIONS);});
+
+  int msec = stats.min/1e6;
+
+  auto p_view = std::as_const(p).view();
+  real av_error = 0.0;
+  for(int i=1; i<NX-1; ++i) {
+    for(int j=1; j<NY-1; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+      av_error += fabs(p_view(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+    }
+  }
+  av_error /= (double(NX)*NY);
+
+  const double ns_per_update = stats.min/(points*MAX_ITERATIONS);
+  const double footprint_kb = 3.0*p.span_size()*sizeof(real)/1024;
+
+  printf("%s, cpp, %d, %d, %d, %d, %e, %s, %f, %f\n", exe_name, NX, NY, MAX_ITERATIONS, msec, av_error,
+         Layout::name, footprint_kb, ns_per_update);
+  fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+  // Total point updates per measurement, so each size takes roughly the same time
+  const double TARGET_UPDATES = argc > 1 ? atof(argv[1]) : double(1<<28);
+
+  vector<int> sizes;
+  for(int k=2; k<argc; ++k) sizes.push_back(atoi(argv[k]));
+  if(sizes.empty()) sizes = {128, 512, 2048};
+
+  for(const int size : sizes) {
+    benchmark_layout<layout_right>(argv[0], size, size, TARGET_UPDATES);
+    benchmark_layout<layout_left>(argv[0], size, size, TARGET_UPDATES);
+    benchmark_layout<layout_tiled<8>>(argv[0], size, size, TARGET_UPDATES);
+    benchmark_layout<layout_tiled<16>>(argv[0], size, size, TARGET_UPDATES);
+    benchmark_layout<layout_morton>(argv[0], size, size, TARGET_UPDATES);
+  }
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "harness.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(size_t(nx_in)*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  size_t idx(int i, int j) const {return j + size_t(i)*ny;}
+  real* row(const int i) {return data.data() + idx(i,0);}
+  const real* row(const int i) const {return data.data() + idx(i,0);}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// The V008 kernel, with a second full grid to ping-pong between. p_new is
+// allocated by the caller so that neither its allocation nor its first-touch
+// page faults are timed.
+void run_jacobi_ping_pong(Array& p, Array& p_new, const Array& b, const real dx, const real dy, const int max_iterations) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+  }
+}
+
+// Exact Jacobi in place with two row buffers. Row i's new values go to a
+// buffer, and are only written back over row i once row i+1 has been
+// computed, which is the last time the old row i is needed. So every point
+// still sees only old values, as in the ping-pong version, but the extra
+// storage is two rows instead of a whole grid, and p_new is unused.
+void run_jacobi_in_place(Array& p, Array&, const Array& b, const real dx, const real dy, const int max_iterations) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  const int nx = p.nx;
+  const int ny = p.ny;
+  vector<real> buffer_a(ny);
+  vector<real> buffer_b(ny);
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    real* new_prev = buffer_a.data();
+    real* new_row = buffer_b.data();
+    for(int i=1; i<nx-1; ++i) {
+      // The restrict pointers are scoped to the row update, since the memcpy
+      // below writes through p.row(i-1), which above points into
+      {
+        const real* __restrict above = p.row(i-1);
+        const real* __restrict centre = p.row(i);
+        const real* __restrict below = p.row(i+1);
+        const real* __restrict b_row = b.row(i);
+        real* __restrict out = new_row;
+        for(int j=1; j<ny-1; ++j) {
+          out[j] = D_x*(below[j] + above[j]) + D_y*(centre[j+1] + centre[j-1]) + B*b_row[j];
+        }
+      }
+      // The old row i-1 has now been used for the last time
+      if(i > 1) memcpy(p.row(i-1) + 1, new_prev + 1, (ny-2)*sizeof(real));
+      std::swap(new_prev, new_row);
+    }
+    if(nx > 2) memcpy(p.row(nx-2) + 1, new_prev + 1, (ny-2)*sizeof(real));
+  }
+}
+
+typedef void (*Kernel)(Array&, Array&, const Array&, const real, const real, const int);
+
+int main(int argc, char* argv[]) {
+  // Total point updates per measurement, so each size takes roughly the same time
+  const double TARGET_UPDATES = argc > 1 ? atof(argv[1]) : double(1<<28);
+
+  vector<int> sizes;
+  for(int k=2; k<argc; ++k) sizes.push_back(atoi(argv[k]));
+  if(sizes.empty()) sizes = {128, 512, 1024, 2048, 4096};
+
+  const char* names[2] = {"ping_pong", "in_place"};
+  const Kernel kernels[2] = {run_jacobi_ping_pong, run_jacobi_in_place};
+  // Full grids held by each: p and b, plus p_new for ping-pong
+  const int grids[2] = {3, 2};
+
+  HarnessOptions options;
+  options.warmups = 1;
+  options.repeats = 3;
+
+  for(const int size : sizes) {
+    const int NX = size;
+    const int NY = size;
+    const double points = double(NX-2)*(NY-2);
+    const int MAX_ITERATIONS = std::max(1.0, std::round(TARGET_UPDATES/points));
+
+    Array b(NX, NY);
+
+    real dx = 1.0/(NX-1);
+    real dy = 1.0/(NY-1);
+
+    for(int i=0; i<NX; ++i) {
+      for(int j=0; j<NY; ++j) {
+        real x = i*dx;
+        real y = j*dx;
+
+        b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+      }
+    }
+
+    vector<Array> results;
+    for(int k=0; k<2; ++k) {
+      Array p(NX, NY);
+      // Only ping-pong needs it, but the in-place kernel is given the same
+      // setup so the two are timed alike
+      Array p_new(NX, NY);
+      Stats stats = run_harness(options,
+        [&]{
+          std::fill(p.row(0), p.row(0) + size_t(NX)*NY, 0.0);
+          std::fill(p_new.row(0), p_new.row(0) + size_t(NX)*NY, 0.0);
+        },
+        [&]{kernels[k](p, p_new, b, dx, dy, MAX_ITERATIONS);});
+
+      int msec = stats.min/1e6;
+
+      real av_error = 0.0;
+      for(int i=1; i<NX-1; ++i) {
+        for(int j=1; j<NY-1; ++j) {
+          real x = i*dx;
+          real y = j*dx;
+          av_error += fabs(p(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+        }
+      }
+      av_error /= (double(NX)*NY);
+
+      // Compared with the ping-pong result, which must match exactly
+      results.push_back(p);
+      real max_diff = 0.0;
+      for(int i=0; i<NX; ++i) {
+        for(int j=0; j<NY; ++j) {
+          max_diff = std::max(max_diff, real(fabs(p(i,j) - results[0](i,j))));
+        }
+      }
+
+      const double ns_per_update = stats.min/(points*MAX_ITERATIONS);
+      const double footprint_kb = double(grids[k])*NX*NY*sizeof(real)/1024;
+
+      printf("%s, cpp, %d, %d, %d, %d, %e, %s, %f, %f, %e\n", argv[0], NX, NY, MAX_ITERATIONS, msec, av_error,
+             names[k], footprint_kb, ns_per_update, max_diff);
+      fflush(stdout);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,253 @@
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <unistd.h>
+#ifdef __AVX__
+#include <immintrin.h>
+// Whether run_jacobi_streaming actually issues streaming stores
+const bool HAVE_STREAMING_STORES = true;
+#else
+const bool HAVE_STREAMING_STORES = false;
+#endif
+#include "harness.hpp"
+#include "perf_counters.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(size_t(nx_in)*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  size_t idx(int i, int j) const {return j + size_t(i)*ny;}
+  real* row(const int i) {return data.data() + idx(i,0);}
+  const real* row(const int i) const {return data.data() + idx(i,0);}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// The V008 kernel. Both kernels are given p_new by the caller, so its
+// allocation and first-touch page faults are not timed.
+void run_jacobi_default(Array& p, Array& p_new, const Array& b, const real dx, const real dy, const int max_iterations,
+                        const int) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+  }
+}
+
+#ifdef __AVX__
+// 256-bit vectors of either precision, so the kernel is written once
+template<typename T> struct Vec;
+template<> struct Vec<double> {
+  typedef __m256d type;
+  static const int width = 4;
+  static type load(const double* x) {return _mm256_loadu_pd(x);}
+  static type set1(const double x) {return _mm256_set1_pd(x);}
+  static type add(const type a, const type b) {return _mm256_add_pd(a, b);}
+  static type mul(const type a, const type b) {return _mm256_mul_pd(a, b);}
+  static void stream(double* x, const type a) {_mm256_stream_pd(x, a);}
+};
+template<> struct Vec<float> {
+  typedef __m256 type;
+  static const int width = 8;
+  static type load(const float* x) {return _mm256_loadu_ps(x);}
+  static type set1(const float x) {return _mm256_set1_ps(x);}
+  static type add(const type a, const type b) {return _mm256_add_ps(a, b);}
+  static type mul(const type a, const type b) {return _mm256_mul_ps(a, b);}
+  static void stream(float* x, const type a) {_mm256_stream_ps(x, a);}
+};
+#endif
+
+// For grids larger than the last-level cache. Writing p_new normally costs a
+// read for ownership of every line first; non-temporal stores write whole
+// lines straight to memory instead, so a sweep moves 3 reals per point rather
+// than 4. Streaming stores need aligned addresses, so each row is peeled to a
+// 32-byte boundary. The rows of p and b are also prefetched prefetch_distance
+// elements ahead of use, or not at all if that is 0. Without AVX this is the
+// scalar loop of the default kernel.
+void run_jacobi_streaming(Array& p, Array& p_new, const Array& b, const real dx, const real dy, const int max_iterations,
+                          const int prefetch_distance) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  const int nx = p.nx;
+  const int ny = p.ny;
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    for(int i=1; i<nx-1; ++i) {
+      const real* __restrict above = p.row(i-1);
+      const real* __restrict centre = p.row(i);
+      const real* __restrict below = p.row(i+1);
+      const real* __restrict b_row = b.row(i);
+      real* __restrict out = p_new.row(i);
+
+      int j = 1;
+#ifdef __AVX__
+      typedef Vec<real> V;
+      while(j < ny-1 && (uintptr_t(out + j) % 32) != 0) {
+        out[j] = D_x*(below[j] + above[j]) + D_y*(centre[j+1] + centre[j-1]) + B*b_row[j];
+        ++j;
+      }
+      const typename V::type v_D_x = V::set1(D_x);
+      const typename V::type v_D_y = V::set1(D_y);
+      const typename V::type v_B = V::set1(B);
+      // One cache line at a time, so there is one prefetch per line per array
+      const int line = 64/sizeof(real);
+      for(; j + line <= ny-1; j += line) {
+        if(prefetch_distance > 0) {
+          // Only row i+1 is new to the cache, the others were read as
+          // neighbours of earlier rows. It is read again for the next two
+          // rows so is kept in all levels, while b is only read once.
+          __builtin_prefetch(below + j + prefetch_distance, 0, 3);
+          __builtin_prefetch(b_row + j + prefetch_distance, 0, 0);
+        }
+        for(int k=j; k<j+line; k+=V::width) {
+          const typename V::type x = V::mul(v_D_x, V::add(V::load(below + k), V::load(above + k)));
+          const typename V::type y = V::mul(v_D_y, V::add(V::load(centre + k + 1), V::load(centre + k - 1)));
+          V::stream(out + k, V::add(V::add(x, y), V::mul(v_B, V::load(b_row + k))));
+        }
+      }
+#else
+      (void)prefetch_distance;
+#endif
+      for(; j < ny-1; ++j) {
+        out[j] = D_x*(below[j] + above[j]) + D_y*(centre[j+1] + centre[j-1]) + B*b_row[j];
+      }
+    }
+#ifdef __AVX__
+    // Streaming stores are weakly ordered, so they have to be fenced before
+    // the next sweep reads them
+    _mm_sfence();
+#endif
+    std::swap(p, p_new);
+  }
+}
+
+// Streaming only pays off once the three grids no longer fit in the
+// last-level cache, and would evict useful lines below that
+bool use_streaming(const int nx, const int ny, const double threshold_bytes) {
+  return 3.0*nx*ny*sizeof(real) > threshold_bytes;
+}
+
+// The entry point a solver would call: streaming stores switch on by
+// themselves once the grids are larger than threshold_bytes
+void run_jacobi(Array& p, Array& p_new, const Array& b, const real dx, const real dy, const int max_iterations,
+                const int prefetch_distance, const double threshold_bytes) {
+  if(use_streaming(p.nx, p.ny, threshold_bytes)) {
+    run_jacobi_streaming(p, p_new, b, dx, dy, max_iterations, prefetch_distance);
+  } else {
+    run_jacobi_default(p, p_new, b, dx, dy, max_iterations, prefetch_distance);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  // Total point updates per measurement, so each size takes roughly the same time
+  const double TARGET_UPDATES = argc > 1 ? atof(argv[1]) : double(1<<28);
+  // Elements ahead to prefetch, 0 to disable
+  const int PREFETCH_DISTANCE = argc > 2 ? atoi(argv[2]) : 0;
+  // Footprint above which streaming is used, 0 for the last-level cache size
+  long llc_size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+  if(llc_size <= 0) llc_size = 64L<<20;
+  const double THRESHOLD_BYTES = argc > 3 && atof(argv[3]) > 0 ? atof(argv[3]) : double(llc_size);
+
+  vector<int> sizes;
+  for(int k=4; k<argc; ++k) sizes.push_back(atoi(argv[k]));
+  if(sizes.empty()) sizes = {512, 2048, 4096};
+
+  HarnessOptions options;
+  options.warmups = 1;
+  options.repeats = 3;
+
+  for(const int size : sizes) {
+    const int NX = size;
+    const int NY = size;
+    const double points = double(NX-2)*(NY-2);
+    const int MAX_ITERATIONS = std::max(1.0, std::round(TARGET_UPDATES/points));
+
+    Array b(NX, NY);
+
+    real dx = 1.0/(NX-1);
+    real dy = 1.0/(NY-1);
+
+    for(int i=0; i<NX; ++i) {
+      for(int j=0; j<NY; ++j) {
+        real x = i*dx;
+        real y = j*dx;
+
+        b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+      }
+    }
+
+    // Both kernels forced, to justify the threshold even below it, then the
+    // dispatching run_jacobi
+    const char* names[3] = {"default", "streaming", "auto"};
+    const bool streaming[3] = {false, HAVE_STREAMING_STORES,
+                               HAVE_STREAMING_STORES && use_streaming(NX, NY, THRESHOLD_BYTES)};
+
+    for(int k=0; k<3; ++k) {
+      Array p(NX, NY);
+      Array p_new(NX, NY);
+      PerfCounters counters;
+      Stats stats = run_harness(options,
+        [&]{
+          std::fill(p.row(0), p.row(0) + size_t(NX)*NY, 0.0);
+          std::fill(p_new.row(0), p_new.row(0) + size_t(NX)*NY, 0.0);
+        },
+        [&]{
+          counters.start();
+          if(k == 0) run_jacobi_default(p, p_new, b, dx, dy, MAX_ITERATIONS, PREFETCH_DISTANCE);
+          else if(k == 1) run_jacobi_streaming(p, p_new, b, dx, dy, MAX_ITERATIONS, PREFETCH_DISTANCE);
+          else run_jacobi(p, p_new, b, dx, dy, MAX_ITERATIONS, PREFETCH_DISTANCE, THRESHOLD_BYTES);
+          counters.stop();
+        });
+
+      int msec = stats.min/1e6;
+
+      real av_error = 0.0;
+      for(int i=1; i<NX-1; ++i) {
+        for(int j=1; j<NY-1; ++j) {
+          real x = i*dx;
+          real y = j*dx;
+          av_error += fabs(p(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+        }
+      }
+      av_error /= (double(NX)*NY);
+
+      const double ns_per_update = stats.min/(points*MAX_ITERATIONS);
+      // Memory traffic per point: streaming avoids the read for ownership of p_new
+      const double gb_per_sweep = (streaming[k] ? 3 : 4)*sizeof(real)*points*1e-9;
+      // Measured, from the last repeat. NaN unless JACOBI_PERF_COUNTERS=1 and
+      // the counter is available.
+      const double llc_misses_per_sweep = counters.value(PerfCounters::LLC_MISSES)/MAX_ITERATIONS;
+
+      printf("%s, cpp, %d, %d, %d, %d, %e, %s, %d, %d, %f, %f, %.0f\n", argv[0], NX, NY, MAX_ITERATIONS, msec, av_error,
+             names[k], int(streaming[k]), PREFETCH_DISTANCE, ns_per_update, gb_per_sweep, llc_misses_per_sweep);
+      fflush(stdout);
+    }
+  }
+
+  return 0;
+}
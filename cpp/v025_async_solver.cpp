@@ -0,0 +1,234 @@
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include "harness.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(nx_in*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  int idx(int i, int j) const {return j + i*ny;}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// The blocking V008 kernel, as the baseline
+void run_jacobi(Array& p, const Array& b, const real dx, const real dy, const int max_iterations) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  Array p_new(p.nx,p.ny);
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+    std::swap(p, p_new);
+  }
+}
+
+// An asynchronous solve runs on its own thread and is controlled through a
+// SolveHandle. Every check_interval iterations the solver publishes its
+// progress, calls the optional progress callback on its own thread, and stops
+// early if cancellation has been requested. The residual published is the
+// RMS change over the last sweep, which is computed only on those sweeps, so
+// between checks the loop is exactly the blocking one.
+
+struct SolveOptions {
+  int max_iterations = 1<<16;
+  int check_interval = 1024;
+  std::function<void(int iteration, double residual)> on_progress;
+};
+
+struct SolveResult {
+  int iterations = 0;
+  double residual = NAN;
+  bool cancelled = false;
+};
+
+struct SolveState {
+  std::atomic<int> iteration{0};
+  std::atomic<double> residual{NAN};
+  std::atomic<bool> cancel_requested{false};
+};
+
+class SolveHandle {
+  public:
+  SolveHandle(std::shared_ptr<SolveState> state_in, std::future<SolveResult> result_in) :
+    state{std::move(state_in)}, result{std::move(result_in)}
+  {}
+  SolveHandle(SolveHandle&&) = default;
+  SolveHandle& operator=(SolveHandle&&) = default;
+
+  // A handle going out of scope cancels the solve and waits for it, so the
+  // arrays it refers to are never used after the caller has moved on
+  ~SolveHandle() {
+    if(result.valid()) {
+      cancel();
+      result.wait();
+    }
+  }
+
+  int iteration() const {return state->iteration.load(std::memory_order_relaxed);}
+  double residual() const {return state->residual.load(std::memory_order_relaxed);}
+  bool done() const {return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;}
+  void cancel() {state->cancel_requested.store(true, std::memory_order_relaxed);}
+  SolveResult wait() {return result.get();}
+
+  private:
+    std::shared_ptr<SolveState> state;
+    std::future<SolveResult> result;
+};
+
+SolveResult run_jacobi_checked(Array& p, const Array& b, const real dx, const real dy, const SolveOptions& options,
+                               SolveState& state) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  SolveResult result;
+  Array p_new(p.nx,p.ny);
+  int iter = 0;
+  while(iter < options.max_iterations) {
+    const int chunk_end = std::min(iter + options.check_interval, options.max_iterations);
+    for(; iter<chunk_end-1; ++iter) {
+      for(int i=1; i<p.nx-1; ++i) {
+        for(int j=1; j<p.ny-1; ++j) {
+          p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+        }
+      }
+      std::swap(p, p_new);
+    }
+
+    // The last sweep of the chunk also measures the change
+    real change = 0.0;
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+        change += (p_new(i,j) - p(i,j))*(p_new(i,j) - p(i,j));
+      }
+    }
+    std::swap(p, p_new);
+    ++iter;
+
+    result.iterations = iter;
+    result.residual = std::sqrt(change/((p.nx-2)*(p.ny-2)));
+    state.iteration.store(iter, std::memory_order_relaxed);
+    state.residual.store(result.residual, std::memory_order_relaxed);
+    if(options.on_progress) options.on_progress(iter, result.residual);
+    if(state.cancel_requested.load(std::memory_order_relaxed)) {
+      result.cancelled = iter < options.max_iterations;
+      break;
+    }
+  }
+  return result;
+}
+
+// p and b must outlive the handle
+SolveHandle solve_async(Array& p, const Array& b, const real dx, const real dy, const SolveOptions& options) {
+  auto state = std::make_shared<SolveState>();
+  std::future<SolveResult> result = std::async(std::launch::async,
+    [&p, &b, dx, dy, options, state]{return run_jacobi_checked(p, b, dx, dy, options, *state);});
+  return SolveHandle(state, std::move(result));
+}
+
+int main(int argc, char* argv[]) {
+  const int NX = argc > 1 ? atoi(argv[1]) : 128;
+  const int NY = argc > 2 ? atoi(argv[2]) : 128;
+  const int MAX_ITERATIONS = argc > 3 ? atoi(argv[3]) : 1<<16;
+  const int CHECK_INTERVAL = argc > 4 ? atoi(argv[4]) : 1024;
+  // When to cancel the final solve, as a fraction of the blocking solve time
+  const double CANCEL_FRACTION = argc > 5 ? atof(argv[5]) : 0.25;
+
+  Array p(NX, NY);
+  Array b(NX, NY);
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  for(int i=0; i<NX; ++i) {
+    for(int j=0; j<NY; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+
+      b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+    }
+  }
+
+  HarnessOptions harness;
+  harness.warmups = 1;
+  harness.repeats = 5;
+  auto reset = [&]{for(int i=0; i<NX; ++i) for(int j=0; j<NY; ++j) p(i,j) = 0.0;};
+
+  SolveOptions options;
+  options.max_iterations = MAX_ITERATIONS;
+  options.check_interval = CHECK_INTERVAL;
+
+  // The blocking kernel against an async solve that is only awaited, so
+  // nothing polls it and no callback is set. The overhead includes starting
+  // and joining the solver's thread, since that is part of every async solve;
+  // the cost of that alone is timed separately on an empty task.
+  Stats blocking = run_harness(harness, reset, [&]{run_jacobi(p, b, dx, dy, MAX_ITERATIONS);});
+  Stats async = run_harness(harness, reset, [&]{solve_async(p, b, dx, dy, options).wait();});
+  const double overhead = (async.min - blocking.min)/blocking.min;
+  HarnessOptions thread_harness;
+  thread_harness.repeats = 100;
+  Stats thread_start = run_harness(thread_harness, []{}, []{std::async(std::launch::async, []{}).wait();});
+
+  // The error of the awaited async solve
+  int msec = async.min/1e6;
+  real av_error = 0.0;
+  for(int i=1; i<NX-1; ++i) {
+    for(int j=1; j<NY-1; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+      av_error += fabs(p(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+    }
+  }
+  av_error /= (NX*NY);
+
+  // A superseded request: poll the handle and cancel partway through, timing
+  // how long the solver takes to notice. The callback counts the progress
+  // reports made before that.
+  reset();
+  int n_callbacks = 0;
+  options.on_progress = [&](int, double){++n_callbacks;};
+  SolveHandle handle = solve_async(p, b, dx, dy, options);
+  auto cancel_at = std::chrono::steady_clock::now() + std::chrono::nanoseconds(long(CANCEL_FRACTION*blocking.min));
+  while(!handle.done() && std::chrono::steady_clock::now() < cancel_at) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  auto cancel_start = std::chrono::steady_clock::now();
+  handle.cancel();
+  SolveResult cancelled = handle.wait();
+  const double cancel_latency_us = elapsed_ns(cancel_start, std::chrono::steady_clock::now())/1e3;
+
+  printf("%s, cpp, %d, %d, %d, %d, %e, %d, %f, %f, %f, %d, %d, %e, %f, %d\n", argv[0], NX, NY, MAX_ITERATIONS, msec,
+         av_error, CHECK_INTERVAL, blocking.min/1e6, overhead, thread_start.min/1e3, cancelled.cancelled,
+         cancelled.iterations, cancelled.residual, cancel_latency_us, n_callbacks);
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include "harness.hpp"
+#include "jacobi_solver.hpp"
+
+using jacobi::real;
+using jacobi::Array;
+using jacobi::JacobiSolver;
+using jacobi::SolverOptions;
+
+// A sequence of problems whose right-hand side changes slightly from one to
+// the next, as in a time-stepping code: the V008 source plus a growing
+// amount of another mode. Both modes have analytic solutions, so each
+// answer can still be checked.
+void make_problem(Array& b, const int k, const double perturbation, const real dx, const real dy) {
+  for(int i=0; i<b.nx; ++i) {
+    for(int j=0; j<b.ny; ++j) {
+      real x = i*dx;
+      real y = j*dy;
+      b(i,j) = sin(M_PI*x)*sin(M_PI*y) + k*perturbation*sin(2*M_PI*x)*sin(3*M_PI*y);
+    }
+  }
+}
+
+real av_error(const Array& p, const int k, const double perturbation, const real dx, const real dy) {
+  real av_error = 0.0;
+  for(int i=1; i<p.nx-1; ++i) {
+    for(int j=1; j<p.ny-1; ++j) {
+      real x = i*dx;
+      real y = j*dy;
+      real p_soln = -sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI) - k*perturbation*sin(2*M_PI*x)*sin(3*M_PI*y)/(13.0*M_PI*M_PI);
+      av_error += fabs(p(i,j) - p_soln);
+    }
+  }
+  return av_error/(p.nx*p.ny);
+}
+
+int main(int argc, char* argv[]) {
+  const int NX = argc > 1 ? atoi(argv[1]) : 128;
+  const int NY = argc > 2 ? atoi(argv[2]) : 128;
+  const int N_PROBLEMS = argc > 3 ? atoi(argv[3]) : 10;
+  const double PERTURBATION = argc > 4 ? atof(argv[4]) : 1e-3;
+  const double TOLERANCE = argc > 5 ? atof(argv[5]) : 1e-4;
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  Array b(NX, NY);
+  JacobiSolver solver(NX, NY, dx, dy);
+  SolverOptions options;
+  options.tolerance = TOLERANCE;
+
+  // The same sequence, cold from zero each time and then warm from the last
+  // answer. The first warm solve is necessarily cold.
+  int iterations[2] = {0, 0};
+  // Excluding the first problem, which is the same either way
+  int later_iterations[2] = {0, 0};
+  int msec[2];
+  real last_error = 0.0;
+  for(int warm=0; warm<2; ++warm) {
+    solver.reset();
+    double ns = 0.0;
+    for(int k=0; k<N_PROBLEMS; ++k) {
+      make_problem(b, k, PERTURBATION, dx, dy);
+      if(!warm) solver.reset();
+
+      auto start = std::chrono::steady_clock::now();
+      const int n = solver.solve(b, options);
+      ns += elapsed_ns(start, std::chrono::steady_clock::now());
+      iterations[warm] += n;
+      if(k > 0) later_iterations[warm] += n;
+
+      last_error = av_error(solver.solution(), k, PERTURBATION, dx, dy);
+    }
+    msec[warm] = ns/1e6;
+  }
+
+  printf("%s, cpp, %d, %d, %d, %d, %e, %d, %e, %e, %d, %d, %f\n", argv[0], NX, NY, iterations[1], msec[1], last_error,
+         N_PROBLEMS, PERTURBATION, TOLERANCE, iterations[0], msec[0],
+         double(later_iterations[0])/later_iterations[1]);
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+#include <omp.h>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "harness.hpp"
+#include "reductions.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(size_t(nx_in)*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  size_t idx(int i, int j) const {return j + size_t(i)*ny;}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// Deterministic noise in [-1,1), so the error field isn't smooth
+real noise(const int i, const int j) {
+  unsigned h = i*73856093u ^ j*19349663u;
+  h ^= h >> 13;
+  h *= 0x5bd1e995u;
+  h ^= h >> 15;
+  return (h & 0xffffff)/real(0x800000) - 1;
+}
+
+bool bitwise_equal(const real a, const real b) {return memcmp(&a, &b, sizeof(real)) == 0;}
+
+int main(int argc, char* argv[]) {
+  const int NX = argc > 1 ? atoi(argv[1]) : 2048;
+  const int NY = argc > 2 ? atoi(argv[2]) : 2048;
+  const int MAX_THREADS = argc > 3 ? atoi(argv[3]) : std::max(8, omp_get_max_threads());
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  vector<real> sin_x(NX);
+  vector<real> sin_y(NY);
+  for(int i=0; i<NX; ++i) sin_x[i] = sin(M_PI*i*dx);
+  for(int j=0; j<NY; ++j) sin_y[j] = sin(M_PI*j*dy);
+
+  // A stand-in for a solution, within 0.1% of the analytic one
+  Array p(NX, NY);
+  for(int i=0; i<NX; ++i) {
+    for(int j=0; j<NY; ++j) {
+      p(i,j) = -sin_x[i]*sin_y[j]/(2.0*M_PI*M_PI)*(1 + 1e-3*noise(i,j));
+    }
+  }
+
+  // The av_error term of every version
+  auto term = [&](const int i, const int j) {return real(fabs(p(i,j) + sin_x[i]*sin_y[j]/(2.0*M_PI*M_PI)));};
+
+  // The same terms summed in extended precision, as the reference
+  long double reference = 0.0;
+  for(int i=1; i<NX-1; ++i) {
+    for(int j=1; j<NY-1; ++j) {
+      reference += term(i,j);
+    }
+  }
+
+  HarnessOptions options;
+  options.warmups = 1;
+  options.repeats = 5;
+  const double points = double(NX-2)*(NY-2);
+
+  auto report = [&](const char* method, const int n_threads, const Stats& stats, const real sum, const bool matches) {
+    const real av_error = sum/(double(NX)*NY);
+    const double relative_error = fabs((sum - reference)/reference);
+    printf("%s, cpp, %d, %d, %d, %d, %e, %s, %d, %f, %f, %e, %d\n", argv[0], NX, NY, 0, int(stats.min/1e6), av_error,
+           method, n_threads, stats.min/1e6, points/stats.min, relative_error, matches);
+    fflush(stdout);
+  };
+
+  // The naive serial loop of the other versions
+  real naive = 0.0;
+  Stats stats = run_harness(options, []{}, [&]{
+    real av_error = 0.0;
+    for(int i=1; i<NX-1; ++i) {
+      for(int j=1; j<NY-1; ++j) {
+        av_error += term(i,j);
+      }
+    }
+    naive = av_error;
+  });
+  report("naive", 1, stats, naive, true);
+
+  // Then on each thread count: an OpenMP reduction, whose result depends on
+  // how the loop is split, and the deterministic sum. Both are compared
+  // bitwise with their result on one thread.
+  real first_omp = 0.0;
+  real first_deterministic = 0.0;
+  for(int n_threads=1; n_threads<=MAX_THREADS; n_threads*=2) {
+    omp_set_num_threads(n_threads);
+
+    real omp_sum = 0.0;
+    stats = run_harness(options, []{}, [&]{
+      real av_error = 0.0;
+      #pragma omp parallel for reduction(+:av_error)
+      for(int i=1; i<NX-1; ++i) {
+        #pragma omp simd reduction(+:av_error)
+        for(int j=1; j<NY-1; ++j) {
+          av_error += term(i,j);
+        }
+      }
+      omp_sum = av_error;
+    });
+    if(n_threads == 1) first_omp = omp_sum;
+    report("omp_reduction", n_threads, stats, omp_sum, bitwise_equal(omp_sum, first_omp));
+
+    real deterministic = 0.0;
+    stats = run_harness(options, []{}, [&]{deterministic = deterministic_sum<real>(1, NX-1, 1, NY-1, term);});
+    if(n_threads == 1) first_deterministic = deterministic;
+    report("deterministic", n_threads, stats, deterministic, bitwise_equal(deterministic, first_deterministic));
+  }
+
+  return 0;
+}
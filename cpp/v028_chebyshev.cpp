@@ -0,0 +1,71 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include "harness.hpp"
+#include "jacobi_solver.hpp"
+
+using jacobi::real;
+using jacobi::Array;
+using jacobi::JacobiSolver;
+using jacobi::SolverOptions;
+
+int main(int argc, char* argv[]) {
+  const int NX = argc > 1 ? atoi(argv[1]) : 128;
+  const int NY = argc > 2 ? atoi(argv[2]) : 128;
+  const double TOLERANCE = argc > 3 ? atof(argv[3]) : 1e-6;
+  // Power iterations when measuring the spectral radius
+  const int POWER_ITERATIONS = argc > 4 ? atoi(argv[4]) : 200;
+
+  Array b(NX, NY);
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  for(int i=0; i<NX; ++i) {
+    for(int j=0; j<NY; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+
+      b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+    }
+  }
+
+  JacobiSolver solver(NX, NY, dx, dy);
+
+  auto estimate_start = std::chrono::steady_clock::now();
+  const double measured_rho = solver.measure_spectral_radius(POWER_ITERATIONS);
+  double estimate_msec = elapsed_ns(estimate_start, std::chrono::steady_clock::now())/1e6;
+
+  // Plain Jacobi, then Chebyshev with the analytic and the measured bound,
+  // each run to the same residual
+  const char* methods[3] = {"jacobi", "chebyshev_analytic", "chebyshev_measured"};
+  const double rhos[3] = {0.0, solver.analytic_spectral_radius(), measured_rho};
+  for(int m=0; m<3; ++m) {
+    SolverOptions options;
+    options.tolerance = TOLERANCE;
+    options.max_iterations = 1<<20;
+    options.chebyshev = m > 0;
+    options.spectral_radius = rhos[m];
+
+    solver.reset();
+    auto start = std::chrono::steady_clock::now();
+    const int iterations = solver.solve(b, options);
+    int msec = elapsed_ns(start, std::chrono::steady_clock::now())/1e6;
+
+    const Array& p = solver.solution();
+    real av_error = 0.0;
+    for(int i=1; i<NX-1; ++i) {
+      for(int j=1; j<NY-1; ++j) {
+        real x = i*dx;
+        real y = j*dx;
+        av_error += fabs(p(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+      }
+    }
+    av_error /= (double(NX)*NY);
+
+    printf("%s, cpp, %d, %d, %d, %d, %e, %s, %.12f, %e, %e, %f\n", argv[0], NX, NY, iterations, msec, av_error,
+           methods[m], rhos[m], TOLERANCE, solver.residual(), m == 2 ? estimate_msec : 0.0);
+  }
+
+  return 0;
+}
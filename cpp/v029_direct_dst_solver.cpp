@@ -0,0 +1,95 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include "harness.hpp"
+#include "jacobi_solver.hpp"
+#include "poisson_dst.hpp"
+
+using jacobi::real;
+using jacobi::Array;
+using jacobi::JacobiSolver;
+using jacobi::SolverOptions;
+
+int main(int argc, char* argv[]) {
+  // Largest grid to also converge Jacobi on, as a cross-check
+  const int JACOBI_MAX_SIZE = argc > 1 ? atoi(argv[1]) : 256;
+  // Residual to converge it to
+  const double TOLERANCE = argc > 2 ? atof(argv[2]) : 1e-9;
+
+  std::vector<int> sizes;
+  for(int k=3; k<argc; ++k) sizes.push_back(atoi(argv[k]));
+  if(sizes.empty()) sizes = {128, 256, 1024, 4096};
+
+  HarnessOptions options;
+  options.warmups = 1;
+  options.repeats = 3;
+
+  for(const int size : sizes) {
+    const int NX = size;
+    const int NY = size;
+
+    Array p(NX, NY);
+    Array b(NX, NY);
+
+    real dx = 1.0/(NX-1);
+    real dy = 1.0/(NY-1);
+
+    for(int i=0; i<NX; ++i) {
+      for(int j=0; j<NY; ++j) {
+        real x = i*dx;
+        real y = j*dy;
+
+        b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+      }
+    }
+
+    // Setting up the transforms and eigenvalues is part of the solve
+    Stats stats = run_harness(options, []{}, [&]{
+      PoissonDST poisson(NX, NY, dx, dy);
+      poisson.solve(b, p);
+    });
+
+    int msec = stats.min/1e6;
+
+    real av_error = 0.0;
+    for(int i=1; i<NX-1; ++i) {
+      for(int j=1; j<NY-1; ++j) {
+        real x = i*dx;
+        real y = j*dy;
+        av_error += fabs(p(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+      }
+    }
+    av_error /= (double(NX)*NY);
+
+    // The discrete solution Jacobi converges to should be the same, so the
+    // difference shrinks with the tolerance rather than the grid spacing
+    double jacobi_iterations = NAN;
+    double jacobi_msec = NAN;
+    double max_difference = NAN;
+    if(size <= JACOBI_MAX_SIZE) {
+      JacobiSolver solver(NX, NY, dx, dy);
+      SolverOptions solver_options;
+      solver_options.tolerance = TOLERANCE;
+      solver_options.max_iterations = 1<<22;
+      solver_options.chebyshev = true;
+      auto start = std::chrono::steady_clock::now();
+      jacobi_iterations = solver.solve(b, solver_options);
+      jacobi_msec = elapsed_ns(start, std::chrono::steady_clock::now())/1e6;
+
+      max_difference = 0.0;
+      for(int i=0; i<NX; ++i) {
+        for(int j=0; j<NY; ++j) {
+          max_difference = std::max(max_difference, double(fabs(p(i,j) - solver.solution()(i,j))));
+        }
+      }
+    }
+
+    printf("%s, cpp, %d, %d, %d, %d, %e, %f, %.0f, %f, %e\n", argv[0], NX, NY, 1, msec, av_error,
+           stats.min/1e6, jacobi_iterations, jacobi_msec, max_difference);
+    fflush(stdout);
+  }
+
+  return 0;
+}
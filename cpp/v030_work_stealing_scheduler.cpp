@@ -0,0 +1,242 @@
+#include <vector>
+#include <memory>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include "harness.hpp"
+#include "job_scheduler.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(size_t(nx_in)*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  size_t idx(int i, int j) const {return j + size_t(i)*ny;}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// One independent solve: the usual problem on its own grid
+struct Job {
+  Job(int nx, int ny, int iterations_in) :
+    iterations{iterations_in},
+    p(nx, ny), p_new(nx, ny), b(nx, ny)
+  {
+    real dx = 1.0/(nx-1);
+    real dy = 1.0/(ny-1);
+    for(int i=0; i<nx; ++i) {
+      for(int j=0; j<ny; ++j) {
+        real x = i*dx;
+        real y = j*dx;
+        b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+      }
+    }
+    real D = 2.0*(dx*dx + dy*dy);
+    D_x = dy*dy/D;
+    D_y = dx*dx/D;
+    B = -(dx*dx*dy*dy)/D;
+  }
+
+  void reset() {
+    for(int i=0; i<p.nx; ++i) {
+      for(int j=0; j<p.ny; ++j) {
+        p(i,j) = 0.0;
+        p_new(i,j) = 0.0;
+      }
+    }
+  }
+
+  // One sweep over interior rows [i_start, i_end)
+  void sweep_rows(const int i_start, const int i_end) {
+    for(int i=i_start; i<i_end; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+      }
+    }
+  }
+
+  void run_whole() {
+    for(int iter = 0; iter<iterations; ++iter) {
+      sweep_rows(1, p.nx-1);
+      std::swap(p, p_new);
+    }
+  }
+
+  int iterations;
+  Array p;
+  Array p_new;
+  Array b;
+  real D_x;
+  real D_y;
+  real B;
+};
+
+// A job split into tiles of rows. Each tile of a sweep is its own task, and
+// the last one to finish swaps the arrays and submits the next sweep, so no
+// worker ever blocks waiting for the rest of the sweep.
+class TiledSolve {
+  public:
+  TiledSolve(Job& job_in, Scheduler& scheduler_in, const int tile_rows_in) :
+    job(job_in), scheduler(scheduler_in), tile_rows{tile_rows_in}, iteration{0}
+  {}
+
+  void submit_sweep() {
+    const int n_rows = job.p.nx-2;
+    const int n_tiles = (n_rows + tile_rows - 1)/tile_rows;
+    remaining = n_tiles;
+    for(int t=0; t<n_tiles; ++t) {
+      const int i_start = 1 + t*tile_rows;
+      const int i_end = std::min(i_start + tile_rows, job.p.nx-1);
+      scheduler.submit([this, i_start, i_end]{
+        job.sweep_rows(i_start, i_end);
+        if(remaining.fetch_sub(1) == 1) finish_sweep();
+      });
+    }
+  }
+
+  private:
+    void finish_sweep() {
+      std::swap(job.p, job.p_new);
+      if(++iteration < job.iterations) submit_sweep();
+    }
+
+    Job& job;
+    Scheduler& scheduler;
+    int tile_rows;
+    int iteration;
+    std::atomic<int> remaining;
+};
+
+// Jobs dealt out to the threads in turn before starting, each run whole
+void run_static(vector<std::unique_ptr<Job>>& jobs, const int n_threads) {
+  vector<std::thread> threads;
+  for(int t=0; t<n_threads; ++t) {
+    threads.emplace_back([&jobs, t, n_threads]{
+      for(size_t k=t; k<jobs.size(); k+=n_threads) jobs[k]->run_whole();
+    });
+  }
+  for(auto& thread : threads) thread.join();
+}
+
+// Grids with more than two tiles of interior rows are split, the rest run whole
+void run_work_stealing(vector<std::unique_ptr<Job>>& jobs, Scheduler& scheduler, const int tile_rows) {
+  vector<std::unique_ptr<TiledSolve>> tiled;
+  for(auto& job : jobs) {
+    Job* job_ptr = job.get();
+    if(job->p.nx-2 > 2*tile_rows) {
+      tiled.emplace_back(new TiledSolve(*job_ptr, scheduler, tile_rows));
+      TiledSolve* solve = tiled.back().get();
+      scheduler.submit([solve]{solve->submit_sweep();});
+    } else {
+      scheduler.submit([job_ptr]{job_ptr->run_whole();});
+    }
+  }
+  scheduler.wait();
+}
+
+// Largest share of the point updates any thread is dealt by run_static,
+// relative to an even split: the best speedup static partitioning could
+// reach over one thread is n_threads divided by this
+double static_imbalance(const vector<std::unique_ptr<Job>>& jobs, const int n_threads) {
+  vector<double> updates(n_threads, 0.0);
+  for(size_t k=0; k<jobs.size(); ++k) {
+    updates[k % n_threads] += double(jobs[k]->p.nx-2)*(jobs[k]->p.ny-2)*jobs[k]->iterations;
+  }
+  double total = 0.0;
+  for(const double u : updates) total += u;
+  return *std::max_element(updates.begin(), updates.end())/(total/n_threads);
+}
+
+double average_error(const vector<std::unique_ptr<Job>>& jobs) {
+  double total = 0.0;
+  for(const auto& job : jobs) {
+    const Array& p = job->p;
+    real dx = 1.0/(p.nx-1);
+    real av_error = 0.0;
+    for(int i=1; i<p.nx-1; ++i) {
+      for(int j=1; j<p.ny-1; ++j) {
+        real x = i*dx;
+        real y = j*dx;
+        av_error += fabs(p(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+      }
+    }
+    total += av_error/(double(p.nx)*p.ny);
+  }
+  return total/jobs.size();
+}
+
+int main(int argc, char* argv[]) {
+  const int N_WORKERS = argc > 1 ? atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+  const int N_SMALL = argc > 2 ? atoi(argv[2]) : 256;
+  const int SMALL_SIZE = argc > 3 ? atoi(argv[3]) : 64;
+  const int N_LARGE = argc > 4 ? atoi(argv[4]) : 4;
+  const int LARGE_SIZE = argc > 5 ? atoi(argv[5]) : 512;
+  const int MAX_ITERS = argc > 6 ? atoi(argv[6]) : 400;
+  const int TILE_ROWS = argc > 7 ? atoi(argv[7]) : 64;
+
+  // A mixed queue in a fixed random order, so that dealing it out statically
+  // gives some threads more of the large jobs than others
+  vector<std::unique_ptr<Job>> jobs;
+  for(int k=0; k<N_SMALL; ++k) jobs.emplace_back(new Job(SMALL_SIZE, SMALL_SIZE, MAX_ITERS));
+  for(int k=0; k<N_LARGE; ++k) jobs.emplace_back(new Job(LARGE_SIZE, LARGE_SIZE, MAX_ITERS));
+  std::mt19937 rng(42);
+  std::shuffle(jobs.begin(), jobs.end(), rng);
+
+  HarnessOptions options;
+  options.warmups = 1;
+  options.repeats = 3;
+
+  auto reset_all = [&]{for(auto& job : jobs) job->reset();};
+
+  Stats static_stats = run_harness(options, reset_all, [&]{run_static(jobs, N_WORKERS);});
+  const double static_error = average_error(jobs);
+  vector<Array> reference;
+  for(const auto& job : jobs) reference.push_back(job->p);
+
+  Scheduler scheduler(N_WORKERS);
+  Stats stealing_stats = run_harness(options, reset_all, [&]{run_work_stealing(jobs, scheduler, TILE_ROWS);});
+  const double stealing_error = average_error(jobs);
+  const int runs = options.warmups + options.repeats;
+
+  // Tiling doesn't change the order of any operation on a point, so the
+  // answers should be identical
+  double max_difference = 0.0;
+  for(size_t k=0; k<jobs.size(); ++k) {
+    const Array& p = jobs[k]->p;
+    for(int i=0; i<p.nx; ++i) {
+      for(int j=0; j<p.ny; ++j) {
+        max_difference = std::max(max_difference, double(fabs(p(i,j) - reference[k](i,j))));
+      }
+    }
+  }
+
+  const double imbalance = static_imbalance(jobs, N_WORKERS);
+
+  const char* names[2] = {"static", "work_stealing"};
+  const Stats* stats[2] = {&static_stats, &stealing_stats};
+  const double errors[2] = {static_error, stealing_error};
+  const long tasks[2] = {long(jobs.size()), scheduler.tasks_run()/runs};
+  const long steals[2] = {0, scheduler.steals()/runs};
+  for(int s=0; s<2; ++s) {
+    int msec = stats[s]->min/1e6;
+    printf("%s, cpp, %d, %d, %d, %d, %e, %s, %d, %zu, %f, %ld, %ld, %f, %e\n", argv[0], LARGE_SIZE, LARGE_SIZE, MAX_ITERS, msec, errors[s],
+           names[s], N_WORKERS, jobs.size(), jobs.size()/(stats[s]->min/1e9), tasks[s], steals[s],
+           s == 0 ? imbalance : NAN, max_difference);
+  }
+
+  return 0;
+}
@@ -0,0 +1,184 @@
+#include <omp.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include "harness.hpp"
+#include "autotune.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(size_t(nx_in)*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  size_t idx(int i, int j) const {return j + size_t(i)*ny;}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// The candidates: the V008 loop with its rows shared out between threads,
+// and the same loop over tiles of tile_rows x tile_cols, with the tiles
+// shared out
+void run_jacobi(const TunedConfig& config, Array& p, Array& p_new, const Array& b,
+                const real dx, const real dy, const int max_iterations) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  const int nx = p.nx;
+  const int ny = p.ny;
+  const bool tiled = config.kernel == "tiled";
+  const int tile_rows = tiled ? config.tile_rows : nx;
+  const int tile_cols = tiled ? config.tile_cols : ny;
+  const int n_tiles_i = (nx-2 + tile_rows-1)/tile_rows;
+  const int n_tiles_j = (ny-2 + tile_cols-1)/tile_cols;
+
+  for(int iter = 0; iter<max_iterations; ++iter) {
+    if(tiled) {
+      #pragma omp parallel for collapse(2) num_threads(config.n_threads)
+      for(int ti=0; ti<n_tiles_i; ++ti) {
+        for(int tj=0; tj<n_tiles_j; ++tj) {
+          const int i_end = std::min(1 + (ti+1)*tile_rows, nx-1);
+          const int j_end = std::min(1 + (tj+1)*tile_cols, ny-1);
+          for(int i=1 + ti*tile_rows; i<i_end; ++i) {
+            for(int j=1 + tj*tile_cols; j<j_end; ++j) {
+              p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+            }
+          }
+        }
+      }
+    } else {
+      #pragma omp parallel for num_threads(config.n_threads)
+      for(int i=1; i<nx-1; ++i) {
+        for(int j=1; j<ny-1; ++j) {
+          p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+        }
+      }
+    }
+    std::swap(p, p_new);
+  }
+}
+
+vector<TunedConfig> candidates(const int ny) {
+  vector<TunedConfig> configs;
+  const int max_threads = omp_get_max_threads();
+  vector<int> thread_counts;
+  for(int n=1; n<max_threads; n*=2) thread_counts.push_back(n);
+  thread_counts.push_back(max_threads);
+  for(const int n_threads : thread_counts) {
+    TunedConfig rows;
+    rows.kernel = "rows";
+    rows.n_threads = n_threads;
+    configs.push_back(rows);
+    for(const int tile_rows : {8, 32, 128}) {
+      for(const int tile_cols : {128, 512, 2048}) {
+        // Tiles as wide as the grid are the rows kernel again
+        if(tile_cols >= ny-2) continue;
+        TunedConfig tiled;
+        tiled.kernel = "tiled";
+        tiled.tile_rows = tile_rows;
+        tiled.tile_cols = tile_cols;
+        tiled.n_threads = n_threads;
+        configs.push_back(tiled);
+      }
+    }
+  }
+  return configs;
+}
+
+int main(int argc, char* argv[]) {
+  const int NX = argc > 1 ? atoi(argv[1]) : 2048;
+  const int NY = argc > 2 ? atoi(argv[2]) : 2048;
+  const int MAX_ITERS = argc > 3 ? atoi(argv[3]) : 200;
+  // Ignore any cached result and tune again
+  const bool RETUNE = argc > 4 ? atoi(argv[4]) : false;
+
+  Array p(NX, NY);
+  Array p_new(NX, NY);
+  Array b(NX, NY);
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  for(int i=0; i<NX; ++i) {
+    for(int j=0; j<NY; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+
+      b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+    }
+  }
+
+  auto reset = [&]{
+    for(int i=0; i<NX; ++i) {
+      for(int j=0; j<NY; ++j) {
+        p(i,j) = 0.0;
+        p_new(i,j) = 0.0;
+      }
+    }
+  };
+
+  // Each candidate gets enough sweeps for about 20 million updates per
+  // sample, so small grids aren't timed on a single sweep
+  const double points = double(NX-2)*(NY-2);
+  const int tuning_sweeps = std::max(1, int(2e7/points));
+  HarnessOptions options;
+  options.warmups = 1;
+  options.repeats = 3;
+  auto measure = [&](const TunedConfig& config) {
+    Stats stats = run_harness(options, reset, [&]{run_jacobi(config, p, p_new, b, dx, dy, tuning_sweeps);});
+    return stats.min/(points*tuning_sweeps);
+  };
+
+  TuningKey key = {cpu_model(), sizeof(real) == sizeof(float) ? "float" : "double", NX, NY, omp_get_max_threads()};
+  auto tune_start = std::chrono::steady_clock::now();
+  AutotuneCache cache;
+  bool cache_hit;
+  const TunedConfig config = autotune(cache, key, candidates(NY), measure, cache_hit, RETUNE);
+  const double tune_msec = elapsed_ns(tune_start, std::chrono::steady_clock::now())/1e6;
+
+  // The untuned V008 loop on one thread, for comparison
+  TunedConfig untuned;
+  untuned.kernel = "rows";
+  reset();
+  auto start = std::chrono::steady_clock::now();
+  run_jacobi(untuned, p, p_new, b, dx, dy, MAX_ITERS);
+  const double untuned_msec = elapsed_ns(start, std::chrono::steady_clock::now())/1e6;
+
+  reset();
+  start = std::chrono::steady_clock::now();
+  run_jacobi(config, p, p_new, b, dx, dy, MAX_ITERS);
+  const double tuned_msec = elapsed_ns(start, std::chrono::steady_clock::now())/1e6;
+
+  int msec = tuned_msec;
+
+  real av_error = 0.0;
+  for(int i=1; i<NX-1; ++i) {
+    for(int j=1; j<NY-1; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+      av_error += fabs(p(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+    }
+  }
+  av_error /= (double(NX)*NY);
+
+  printf("%s, cpp, %d, %d, %d, %d, %e, %s, %d, %d, %d, %f, %d, %f, %f\n", argv[0], NX, NY, MAX_ITERS, msec, av_error,
+         config.kernel.c_str(), config.tile_rows, config.tile_cols, config.n_threads, config.ns_per_update,
+         cache_hit, tune_msec, untuned_msec/tuned_msec);
+
+  return 0;
+}
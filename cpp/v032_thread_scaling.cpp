@@ -0,0 +1,148 @@
+#include <omp.h>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include "harness.hpp"
+#include "affinity.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+// Left uninitialised on allocation so that the parallel setup loop touches
+// each page first, from the thread, and so the socket, that will use it
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(new real[size_t(nx_in)*ny_in])
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  size_t idx(int i, int j) const {return j + size_t(i)*ny;}
+
+  int nx;
+  int ny;
+  private:
+    std::unique_ptr<real[]> data;
+};
+
+struct Result {
+  double ns;
+  real av_error;
+};
+
+// Solves on an nx x ny grid with n_threads threads, placed on cpus in order
+Result run_jacobi(const int n_threads, const vector<int>& cpus, const int NX, const int NY, const int max_iterations) {
+  // OpenMP keeps its threads between parallel regions, so they stay pinned
+  #pragma omp parallel num_threads(n_threads)
+  pin_thread(cpus.empty() ? -1 : cpus[omp_get_thread_num() % cpus.size()]);
+
+  Array p(NX, NY);
+  Array p_new(NX, NY);
+  Array b(NX, NY);
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  auto setup = [&]{
+    #pragma omp parallel for schedule(static) num_threads(n_threads)
+    for(int i=0; i<NX; ++i) {
+      for(int j=0; j<NY; ++j) {
+        real x = i*dx;
+        real y = j*dx;
+        b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+        p(i,j) = 0.0;
+        p_new(i,j) = 0.0;
+      }
+    }
+  };
+
+  HarnessOptions options;
+  options.warmups = 1;
+  options.repeats = 3;
+  Stats stats = run_harness(options, setup, [&]{
+    for(int iter = 0; iter<max_iterations; ++iter) {
+      #pragma omp parallel for schedule(static) num_threads(n_threads)
+      for(int i=1; i<NX-1; ++i) {
+        for(int j=1; j<NY-1; ++j) {
+          p_new(i,j) = D_x*(p(i+1,j) + p(i-1,j)) + D_y*(p(i,j+1) + p(i,j-1)) + B*b(i,j);
+        }
+      }
+      std::swap(p, p_new);
+    }
+  });
+
+  real av_error = 0.0;
+  #pragma omp parallel for schedule(static) num_threads(n_threads) reduction(+:av_error)
+  for(int i=1; i<NX-1; ++i) {
+    for(int j=1; j<NY-1; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+      av_error += fabs(p(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+    }
+  }
+  av_error /= (double(NX)*NY);
+
+  return {stats.min, av_error};
+}
+
+int main(int argc, char* argv[]) {
+  const char* POLICY = argc > 1 ? argv[1] : "compact";
+  const int STRONG_SIZE = argc > 3 ? atoi(argv[3]) : 8192;
+  // Interior points per thread in the weak scaling runs
+  const double WEAK_POINTS = argc > 4 ? atof(argv[4]) : 1024.0*1024.0;
+  const int MAX_ITERS = argc > 5 ? atoi(argv[5]) : 10;
+
+  AffinityPolicy policy;
+  int socket;
+  if(!parse_affinity_policy(POLICY, policy, socket)) {
+    fprintf(stderr, "Unknown affinity policy %s, expected none, compact, scatter, cores or socket:N\n", POLICY);
+    return 1;
+  }
+  const vector<int> cpus = affinity_cpus(policy, socket);
+  if(policy != AFFINITY_NONE && cpus.empty()) {
+    fprintf(stderr, "No usable CPUs for affinity policy %s\n", POLICY);
+    return 1;
+  }
+  // One thread per CPU of the policy by default
+  const int MAX_THREADS = argc > 2 ? atoi(argv[2]) : (cpus.empty() ? omp_get_num_procs() : int(cpus.size()));
+
+  vector<int> thread_counts;
+  for(int n=1; n<MAX_THREADS; n*=2) thread_counts.push_back(n);
+  thread_counts.push_back(MAX_THREADS);
+
+  // Strong scaling divides a fixed grid between more threads. Weak scaling
+  // grows the grid with the thread count, so efficiency compares the time
+  // per update per thread with one thread's.
+  for(const char* mode : {"strong", "weak"}) {
+    const bool strong = mode[0] == 's';
+    double ns_per_update_1 = 0.0;
+    for(const int n_threads : thread_counts) {
+      const int size = strong ? STRONG_SIZE : int(std::lround(std::sqrt(WEAK_POINTS*n_threads))) + 2;
+      Result result = run_jacobi(n_threads, cpus, size, size, MAX_ITERS);
+
+      const double updates = double(size-2)*(size-2)*MAX_ITERS;
+      const double ns_per_update = result.ns/updates;
+      if(n_threads == 1) ns_per_update_1 = ns_per_update;
+      // Work done relative to one thread doing the same grid
+      const double speedup = ns_per_update_1/ns_per_update;
+      const double efficiency = speedup/n_threads;
+
+      int msec = result.ns/1e6;
+      printf("%s, cpp, %d, %d, %d, %d, %e, %s, %s, %d, %s, %f, %f\n", argv[0], size, size, MAX_ITERS, msec, result.av_error,
+             mode, POLICY, n_threads, cpu_list(cpus, n_threads).c_str(), speedup, efficiency);
+      fflush(stdout);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,253 @@
+#include <omp.h>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include "harness.hpp"
+#include "trace.hpp"
+
+using std::vector;
+
+typedef PRECISION real;
+
+class Array {
+  public:
+  Array(int nx_in, int ny_in) :
+    nx{nx_in}, ny{ny_in},
+    data(size_t(nx_in)*ny_in)
+  {}
+  const real& operator()(const int i, const int j) const {return data[idx(i,j)];}
+  real& operator()(const int i, const int j) {return data[idx(i,j)];}
+  size_t idx(int i, int j) const {return j + size_t(i)*ny;}
+  real* ptr() {return data.data();}
+
+  int nx;
+  int ny;
+  private:
+    vector<real> data;
+};
+
+// One parallel region for the whole solve. Each thread sweeps its own block
+// of rows, waits at a barrier, and every check_interval iterations adds up
+// its part of the RMS change, which every thread then totals in the same
+// order. Returns the last RMS change. Each phase is traced.
+real run_jacobi(Array& p_array, Array& p_new_array, const Array& b_array, const real dx, const real dy,
+                const int max_iterations, const int n_threads, const int check_interval) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  const int nx = p_array.nx;
+  const int ny = p_array.ny;
+  const real* b = &b_array(0,0);
+  vector<real> partials(n_threads);
+  real rms_change = 0.0;
+
+  #pragma omp parallel num_threads(n_threads)
+  {
+    TRACE_THREAD("jacobi " + std::to_string(omp_get_thread_num()));
+    const int thread = omp_get_thread_num();
+    const int i_start = 1 + (nx-2)*thread/n_threads;
+    const int i_end = 1 + (nx-2)*(thread+1)/n_threads;
+    real* p = p_array.ptr();
+    real* p_new = p_new_array.ptr();
+
+    for(int iter = 0; iter<max_iterations; ++iter) {
+      {
+        TRACE_SCOPE("sweep");
+        for(int i=i_start; i<i_end; ++i) {
+          const size_t row = size_t(i)*ny;
+          for(int j=1; j<ny-1; ++j) {
+            p_new[row + j] = D_x*(p[row + ny + j] + p[row - ny + j]) + D_y*(p[row + j+1] + p[row + j-1]) + B*b[row + j];
+          }
+        }
+      }
+      {
+        TRACE_SCOPE("barrier");
+        #pragma omp barrier
+      }
+      if((iter+1) % check_interval == 0) {
+        TRACE_SCOPE("reduction");
+        real change = 0.0;
+        for(int i=i_start; i<i_end; ++i) {
+          const size_t row = size_t(i)*ny;
+          for(int j=1; j<ny-1; ++j) {
+            change += (p_new[row + j] - p[row + j])*(p_new[row + j] - p[row + j]);
+          }
+        }
+        partials[thread] = change;
+        #pragma omp barrier
+        real total = 0.0;
+        for(int t=0; t<n_threads; ++t) total += partials[t];
+        if(thread == 0) rms_change = std::sqrt(total/(double(nx-2)*(ny-2)));
+        // Nobody may overwrite its partial before everyone has read them
+        #pragma omp barrier
+      }
+      std::swap(p, p_new);
+    }
+  }
+
+  if(max_iterations % 2) std::swap(p_array, p_new_array);
+  return rms_change;
+}
+
+// Exactly the same without any trace macros, as the baseline
+real run_jacobi_untraced(Array& p_array, Array& p_new_array, const Array& b_array, const real dx, const real dy,
+                         const int max_iterations, const int n_threads, const int check_interval) {
+  real D = 2.0*(dx*dx + dy*dy);
+  real D_x = dy*dy/D;
+  real D_y = dx*dx/D;
+  real B = -(dx*dx*dy*dy)/D;
+
+  const int nx = p_array.nx;
+  const int ny = p_array.ny;
+  const real* b = &b_array(0,0);
+  vector<real> partials(n_threads);
+  real rms_change = 0.0;
+
+  #pragma omp parallel num_threads(n_threads)
+  {
+    const int thread = omp_get_thread_num();
+    const int i_start = 1 + (nx-2)*thread/n_threads;
+    const int i_end = 1 + (nx-2)*(thread+1)/n_threads;
+    real* p = p_array.ptr();
+    real* p_new = p_new_array.ptr();
+
+    for(int iter = 0; iter<max_iterations; ++iter) {
+      for(int i=i_start; i<i_end; ++i) {
+        const size_t row = size_t(i)*ny;
+        for(int j=1; j<ny-1; ++j) {
+          p_new[row + j] = D_x*(p[row + ny + j] + p[row - ny + j]) + D_y*(p[row + j+1] + p[row + j-1]) + B*b[row + j];
+        }
+      }
+      #pragma omp barrier
+      if((iter+1) % check_interval == 0) {
+        real change = 0.0;
+        for(int i=i_start; i<i_end; ++i) {
+          const size_t row = size_t(i)*ny;
+          for(int j=1; j<ny-1; ++j) {
+            change += (p_new[row + j] - p[row + j])*(p_new[row + j] - p[row + j]);
+          }
+        }
+        partials[thread] = change;
+        #pragma omp barrier
+        real total = 0.0;
+        for(int t=0; t<n_threads; ++t) total += partials[t];
+        if(thread == 0) rms_change = std::sqrt(total/(double(nx-2)*(ny-2)));
+        #pragma omp barrier
+      }
+      std::swap(p, p_new);
+    }
+  }
+
+  if(max_iterations % 2) std::swap(p_array, p_new_array);
+  return rms_change;
+}
+
+int main(int argc, char* argv[]) {
+  const int NX = argc > 1 ? atoi(argv[1]) : 512;
+  const int NY = argc > 2 ? atoi(argv[2]) : 512;
+  const int MAX_ITERS = argc > 3 ? atoi(argv[3]) : 1000;
+  const int N_THREADS = argc > 4 ? atoi(argv[4]) : omp_get_max_threads();
+  const int CHECK_INTERVAL = argc > 5 ? atoi(argv[5]) : 16;
+  const char* TRACE_PATH = argc > 6 ? argv[6] : "v033_trace_recorder.trace.json";
+  if(CHECK_INTERVAL < 1) {
+    fprintf(stderr, "Check interval must be at least 1, got %d\n", CHECK_INTERVAL);
+    return 1;
+  }
+
+  Array p(NX, NY);
+  Array p_new(NX, NY);
+  Array b(NX, NY);
+
+  real dx = 1.0/(NX-1);
+  real dy = 1.0/(NY-1);
+
+  for(int i=0; i<NX; ++i) {
+    for(int j=0; j<NY; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+
+      b(i,j) = sin(M_PI*x)*sin(M_PI*y);
+    }
+  }
+
+  auto reset = [&]{
+    for(int i=0; i<NX; ++i) {
+      for(int j=0; j<NY; ++j) {
+        p(i,j) = 0.0;
+        p_new(i,j) = 0.0;
+      }
+    }
+  };
+
+  // Alternating between the two, so that drift in the machine's speed hits
+  // both alike
+  const int REPEATS = 7;
+  vector<double> traced_ns;
+  vector<double> untraced_ns;
+  real traced_change = 0.0;
+  real untraced_change = 0.0;
+  for(int r=0; r<=REPEATS; ++r) {
+    reset();
+    auto start = std::chrono::steady_clock::now();
+    untraced_change = run_jacobi_untraced(p, p_new, b, dx, dy, MAX_ITERS, N_THREADS, CHECK_INTERVAL);
+    if(r > 0) untraced_ns.push_back(elapsed_ns(start, std::chrono::steady_clock::now()));
+
+    reset();
+    start = std::chrono::steady_clock::now();
+    traced_change = run_jacobi(p, p_new, b, dx, dy, MAX_ITERS, N_THREADS, CHECK_INTERVAL);
+    if(r > 0) traced_ns.push_back(elapsed_ns(start, std::chrono::steady_clock::now()));
+  }
+  Stats traced = compute_stats(traced_ns);
+  Stats untraced = compute_stats(untraced_ns);
+
+  TRACE_DUMP(TRACE_PATH);
+
+#ifdef ENABLE_TRACE
+  const bool enabled = true;
+  const long events = TraceRecorder::instance().recorded();
+  const long dropped = TraceRecorder::instance().dropped();
+
+  // The timing noise on a shared machine is larger than the overhead, so it
+  // is also estimated from the cost of one event, timed on a buffer of its own
+  const int N_CALIBRATION = 1<<20;
+  TraceBuffer calibration(-1, "calibration");
+  const int64_t calibration_start = TraceRecorder::instance().now_ns();
+  for(int k=0; k<N_CALIBRATION; ++k) {
+    const int64_t start_ns = TraceRecorder::instance().now_ns();
+    calibration.record("calibration", start_ns, TraceRecorder::instance().now_ns());
+  }
+  const double ns_per_event = double(TraceRecorder::instance().now_ns() - calibration_start)/N_CALIBRATION;
+#else
+  const bool enabled = false;
+  const long events = 0;
+  const long dropped = 0;
+  const double ns_per_event = 0.0;
+#endif
+
+  int msec = traced.min/1e6;
+
+  real av_error = 0.0;
+  for(int i=1; i<NX-1; ++i) {
+    for(int j=1; j<NY-1; ++j) {
+      real x = i*dx;
+      real y = j*dx;
+      av_error += fabs(p(i,j) + sin(M_PI*x)*sin(M_PI*y)/(2.0*M_PI*M_PI));
+    }
+  }
+  av_error /= (double(NX)*NY);
+
+  // Events per thread per iteration, so the granularity is on record
+  const double events_per_iteration = double(events)/(REPEATS+1)/N_THREADS/MAX_ITERS;
+  const double estimated_overhead = ns_per_event*events_per_iteration*MAX_ITERS/untraced.min;
+
+  printf("%s, cpp, %d, %d, %d, %d, %e, %d, %d, %f, %f, %f, %ld, %ld, %f, %f, %f, %d\n", argv[0], NX, NY, MAX_ITERS, msec, av_error,
+         enabled, N_THREADS, untraced.min/1e6, traced.min/1e6, traced.min/untraced.min - 1.0, events, dropped,
+         events_per_iteration, ns_per_event, estimated_overhead, traced_change == untraced_change);
+
+  return 0;
+}
@@ -1,24 +1,81 @@
 #!/usr/bin/env python3
 
 import argparse
+import glob
 import pandas as pd
 
 
+def cache_sizes():
+    """L2 and L3 sizes in bytes from sysfs, or None where unknown"""
+    sizes = {}
+    for index in glob.glob('/sys/devices/system/cpu/cpu0/cache/index*'):
+        try:
+            with open(index + '/level') as f:
+                level = int(f.read())
+            with open(index + '/size') as f:
+                size = f.read().strip()
+        except OSError:
+            continue
+        units = {'K': 1024, 'M': 1024**2}
+        sizes[level] = int(size[:-1])*units[size[-1]] if size[-1] in units else int(size)
+    return sizes.get(2), sizes.get(3)
+
+
 def main():
     parser = argparse.ArgumentParser(
         description="Process CSVs containing microbenchmark performance data")
     parser.add_argument('files', nargs='*')
     parser.add_argument('--sort', default=True, action='store_true')
+    parser.add_argument('--groupby', default='exe_name',
+                        help="Comma-separated columns to group by, e.g. exe_name,n_procs")
+    parser.add_argument('--roofline', metavar='PEAK_GFLOPS,L2_GBS,L3_GBS,DRAM_GBS',
+                        help="Add achieved GFLOP/s and GB/s of the fastest run and its "
+                             "fraction of the roofline, e.g. as measured by v018_roofline. "
+                             "The bandwidth roof is that of the smallest level holding p, "
+                             "p_new and b")
+    parser.add_argument('--cache-sizes', metavar='L2_BYTES,L3_BYTES',
+                        help="Cache sizes for choosing the roof, by default this machine's")
+    parser.add_argument('--real-size', type=int, default=8,
+                        help="Bytes per real for the roofline model")
     args = parser.parse_args()
     df = pd.DataFrame()
     for f in args.files:
         df = pd.concat([df, pd.read_csv(f, sep=',\s+', engine='python')])
 
-    column = df.groupby('exe_name')['runtime']
+    groups = df.groupby(args.groupby.split(','))
+    column = groups['runtime']
     series = [column.min().rename("min"),
               column.mean().rename("mean"),
               column.std().rename("std")]
+
+    if args.roofline:
+        # Each Jacobi point update is 7 flops and moves 4 reals (read p and b,
+        # write p_new plus its read for ownership)
+        peak_gflops, l2_gbs, l3_gbs, dram_gbs = map(float, args.roofline.split(','))
+        if args.cache_sizes:
+            l2_size, l3_size = map(float, args.cache_sizes.split(','))
+        else:
+            l2_size, l3_size = cache_sizes()
+            if l2_size is None or l3_size is None:
+                parser.error("can't read the cache sizes, pass --cache-sizes")
+        sizes = groups[['nx', 'ny', 'max_iterations']].first()
+        points = (sizes['nx']-2)*(sizes['ny']-2)*sizes['max_iterations']
+        seconds = column.min()*1e-3
+        gflops = 7*points/seconds*1e-9
+        gbs = 4*args.real_size*points/seconds*1e-9
+        footprint = 3*args.real_size*sizes['nx']*sizes['ny']
+        level = footprint.map(lambda f: 'L2' if f <= l2_size else 'L3' if f <= l3_size else 'DRAM')
+        bandwidth = level.map({'L2': l2_gbs, 'L3': l3_gbs, 'DRAM': dram_gbs})
+        roof = (7/(4*args.real_size)*bandwidth).clip(upper=peak_gflops)
+        series += [gflops.rename("gflops"),
+                   gbs.rename("gbs"),
+                   level.rename("roof_level"),
+                   (gflops/roof).rename("roof_fraction")]
+
     df = pd.concat(series, axis=1)
+    # Print every column rather than eliding some to fit 80 characters
+    pd.set_option('display.max_columns', None)
+    pd.set_option('display.width', None)
 
     if args.sort:
         print(df.sort_values(by='mean'))